@@ -10,7 +10,7 @@
 
 namespace ycsbc {
 void AcknowledgedCounterGenerator::Acknowledge(uint64_t value) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  GeneratorLock lock(mutex_);
   size_t cur_slot = value & kWindowMask;
   if (ack_window_[cur_slot]) {
     throw utils::Exception("Not enough window size");
@@ -89,6 +89,41 @@ DB::Status BasicDB::Delete(const std::string &table, const std::string &key) {
   return kOK;
 }
 
+class BasicDB::BasicTransaction : public DB::Transaction {
+ public:
+  BasicTransaction(BasicDB *db) : db_(db) {}
+
+  Status Read(const std::string &table, const std::string &key,
+              const std::vector<std::string> *fields, std::vector<Field> &result) {
+    return db_->Read(table, key, fields, result);
+  }
+
+  Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
+    return db_->Update(table, key, values);
+  }
+
+  Status Commit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    *db_->out_ << "COMMIT" << std::endl;
+    return kOK;
+  }
+
+  void Rollback() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    *db_->out_ << "ROLLBACK" << std::endl;
+  }
+
+ private:
+  BasicDB *db_;
+};
+
+DB::Status BasicDB::BeginTransaction(Transaction **txn) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  *out_ << "BEGIN" << std::endl;
+  *txn = new BasicTransaction(this);
+  return kOK;
+}
+
 DB *NewBasicDB() {
   return new BasicDB;
 }
@@ -36,7 +36,11 @@ class BasicDB : public DB {
 
   Status Delete(const std::string &table, const std::string &key);
 
+  Status BeginTransaction(Transaction **txn);
+
  private:
+  class BasicTransaction;
+
   static std::mutex mutex_;
 
   std::ostream *out_;
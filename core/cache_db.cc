@@ -0,0 +1,472 @@
+//
+//  cache_db.cc
+//  YCSB-cpp
+//
+
+#include "cache_db.h"
+#include "utils/utils.h"
+
+#include <functional>
+#include <list>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+  const std::string PROP_CAPACITY = "cache.capacity";
+  const std::string PROP_CAPACITY_DEFAULT = "0";
+
+  const std::string PROP_SHARDS = "cache.shards";
+  const std::string PROP_SHARDS_DEFAULT = "16";
+
+  const std::string PROP_WRITE_POLICY = "cache.writepolicy";
+  const std::string PROP_WRITE_POLICY_DEFAULT = "writethrough";
+
+  std::string CacheKey(const std::string &table, const std::string &key) {
+    std::string cache_key;
+    cache_key.reserve(table.size() + 1 + key.size());
+    cache_key.append(table);
+    cache_key.push_back('\0');
+    cache_key.append(key);
+    return cache_key;
+  }
+
+  // calls f with each field of row, only the listed ones in the listed order
+  // if fields is not null
+  template <typename F>
+  void ForEachField(const std::vector<ycsbc::DB::Field> &row,
+                    const std::vector<std::string> *fields, F f) {
+    if (fields == nullptr) {
+      for (const ycsbc::DB::Field &field : row) {
+        f(field);
+      }
+      return;
+    }
+    for (const std::string &name : *fields) {
+      for (const ycsbc::DB::Field &field : row) {
+        if (field.name == name) {
+          f(field);
+          break;
+        }
+      }
+    }
+  }
+} // anonymous
+
+namespace ycsbc {
+
+///
+/// Records by table and key, split into shards that each keep their own
+/// LRU list under their own lock. Capacity is in bytes of the records.
+///
+class CacheDB::Cache {
+ public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t usage = 0;
+    uint64_t entries = 0;
+  };
+
+  Cache(uint64_t capacity, size_t num_shards) : capacity_(capacity), shards_(num_shards) {
+    for (Shard &shard : shards_) {
+      shard.capacity = capacity / num_shards;
+    }
+  }
+
+  ///
+  /// Returns the cached record, or NULL and the version to pass to Fill().
+  ///
+  std::shared_ptr<const Row> Lookup(const std::string &key, uint64_t *version) {
+    Shard &shard = ShardOf(key);
+    const std::lock_guard<std::mutex> lock(shard.mu);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+      shard.misses++;
+      *version = shard.version;
+      return nullptr;
+    }
+    shard.hits++;
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    return it->second->row;
+  }
+
+  ///
+  /// Caches a record read after a missed Lookup(), unless a write to the
+  /// shard began or ended since then and the record may be outdated.
+  ///
+  void Fill(const std::string &key, std::shared_ptr<const Row> row, uint64_t version) {
+    Shard &shard = ShardOf(key);
+    const std::lock_guard<std::mutex> lock(shard.mu);
+    if (shard.version == version) {
+      Put(shard, key, std::move(row));
+    }
+  }
+
+  ///
+  /// Called before a write of the record to the binding.
+  ///
+  void BeginWrite(const std::string &key) {
+    Shard &shard = ShardOf(key);
+    const std::lock_guard<std::mutex> lock(shard.mu);
+    shard.version++;
+    shard.writing[key]++;
+  }
+
+  ///
+  /// Called after a write of the record to the binding. Replaces the record
+  /// with values if whole is set, or else replaces or adds the fields in
+  /// values if it is cached. The record is dropped if values is NULL or
+  /// another write of it overlapped this one.
+  ///
+  void EndWrite(const std::string &key, const std::vector<Field> *values, bool whole) {
+    Shard &shard = ShardOf(key);
+    const std::lock_guard<std::mutex> lock(shard.mu);
+    shard.version++;
+    auto count = shard.writing.find(key);
+    const bool overlapped = count->second > 1;
+    if (--count->second == 0) {
+      shard.writing.erase(count);
+    }
+    auto it = shard.index.find(key);
+    if (values == nullptr || overlapped) {
+      if (it != shard.index.end()) {
+        Remove(shard, it->second);
+      }
+      return;
+    }
+    if (whole) {
+      Put(shard, key, std::make_shared<const Row>(*values));
+      return;
+    }
+    if (it == shard.index.end()) {
+      return;
+    }
+    std::shared_ptr<Row> row = std::make_shared<Row>(*it->second->row);
+    for (const Field &value : *values) {
+      auto field = row->begin();
+      while (field != row->end() && field->name != value.name) {
+        ++field;
+      }
+      if (field == row->end()) {
+        row->push_back(value);
+      } else {
+        field->value = value.value;
+      }
+    }
+    Put(shard, key, std::move(row));
+  }
+
+  Stats GetStats() {
+    Stats stats;
+    for (Shard &shard : shards_) {
+      const std::lock_guard<std::mutex> lock(shard.mu);
+      stats.hits += shard.hits;
+      stats.misses += shard.misses;
+      stats.usage += shard.usage;
+      stats.entries += shard.index.size();
+    }
+    return stats;
+  }
+
+  uint64_t capacity() const { return capacity_; }
+
+ private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<const Row> row;
+    uint64_t charge;
+  };
+  struct Shard {
+    std::mutex mu;
+    // most recently used first
+    std::list<Entry> lru;
+    // keys point into the entries, which list nodes keep in place
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+    uint64_t capacity = 0;
+    uint64_t usage = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // changed by every write, so that fills can tell if one happened
+    uint64_t version = 0;
+    // writes in progress by key
+    std::unordered_map<std::string, int> writing;
+  };
+
+  Shard &ShardOf(const std::string &key) {
+    return shards_[std::hash<std::string>()(key) % shards_.size()];
+  }
+
+  // approximate heap footprint of an entry
+  static uint64_t Charge(const std::string &key, const Row &row) {
+    uint64_t charge = sizeof(Entry) + key.size() + sizeof(Row);
+    for (const Field &field : row) {
+      charge += sizeof(Field) + field.name.size() + field.value.size();
+    }
+    return charge;
+  }
+
+  void Remove(Shard &shard, std::list<Entry>::iterator entry) {
+    shard.usage -= entry->charge;
+    shard.index.erase(entry->key);
+    shard.lru.erase(entry);
+  }
+
+  void Put(Shard &shard, const std::string &key, std::shared_ptr<const Row> row) {
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+      Remove(shard, it->second);
+    }
+    const uint64_t charge = Charge(key, *row);
+    shard.lru.push_front({key, std::move(row), charge});
+    shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+    shard.usage += charge;
+    while (shard.usage > shard.capacity && !shard.lru.empty()) {
+      Remove(shard, std::prev(shard.lru.end()));
+    }
+  }
+
+  const uint64_t capacity_;
+  std::vector<Shard> shards_;
+};
+
+///
+/// Transaction of the binding that drops the records it updates from the
+/// cache when it ends. Its reads bypass the cache.
+///
+class CacheDB::CacheTransaction : public DB::Transaction {
+ public:
+  explicit CacheTransaction(Transaction *txn) : txn_(txn) {}
+  ~CacheTransaction() {
+    delete txn_;
+  }
+
+  Status Read(const std::string &table, const std::string &key,
+              const std::vector<std::string> *fields, std::vector<Field> &result) {
+    return txn_->Read(table, key, fields, result);
+  }
+
+  Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
+    written_.push_back(CacheKey(table, key));
+    cache_->BeginWrite(written_.back());
+    return txn_->Update(table, key, values);
+  }
+
+  Status Commit() {
+    Status s = txn_->Commit();
+    EndWrites();
+    return s;
+  }
+
+  void Rollback() {
+    txn_->Rollback();
+    EndWrites();
+  }
+
+ private:
+  void EndWrites() {
+    for (const std::string &key : written_) {
+      cache_->EndWrite(key, nullptr, false);
+    }
+    written_.clear();
+  }
+
+  Transaction *txn_;
+  std::vector<std::string> written_;
+};
+
+CacheDB::Cache *CacheDB::cache_ = nullptr;
+bool CacheDB::write_through_ = true;
+int CacheDB::ref_cnt_ = 0;
+uint64_t CacheDB::phase_hits_ = 0;
+uint64_t CacheDB::phase_misses_ = 0;
+std::mutex CacheDB::mu_;
+
+bool CacheDB::Enabled(const utils::Properties &props) {
+  return std::stoull(props.GetProperty(PROP_CAPACITY, PROP_CAPACITY_DEFAULT)) > 0;
+}
+
+CacheSummary CacheDB::TakePhaseSummary() {
+  const std::lock_guard<std::mutex> lock(mu_);
+  CacheSummary summary;
+  if (cache_ == nullptr) {
+    return summary;
+  }
+  Cache::Stats stats = cache_->GetStats();
+  summary.hits = stats.hits - phase_hits_;
+  summary.misses = stats.misses - phase_misses_;
+  summary.usage = stats.usage;
+  summary.capacity = cache_->capacity();
+  summary.entries = stats.entries;
+  phase_hits_ = stats.hits;
+  phase_misses_ = stats.misses;
+  return summary;
+}
+
+CacheDB::CacheDB(DB *db) : db_(db) {
+  const std::lock_guard<std::mutex> lock(mu_);
+  ref_cnt_++;
+}
+
+CacheDB::~CacheDB() {
+  delete db_;
+
+  const std::lock_guard<std::mutex> lock(mu_);
+  if (--ref_cnt_ == 0) {
+    delete cache_;
+    cache_ = nullptr;
+    phase_hits_ = 0;
+    phase_misses_ = 0;
+  }
+}
+
+void CacheDB::Init() {
+  db_->Init();
+
+  const std::lock_guard<std::mutex> lock(mu_);
+  if (cache_) {
+    return;
+  }
+  const std::string policy = props_->GetProperty(PROP_WRITE_POLICY, PROP_WRITE_POLICY_DEFAULT);
+  if (policy == "writethrough") {
+    write_through_ = true;
+  } else if (policy == "invalidate") {
+    write_through_ = false;
+  } else {
+    throw utils::Exception("unknown cache write policy: " + policy);
+  }
+  const size_t num_shards = std::stoul(props_->GetProperty(PROP_SHARDS, PROP_SHARDS_DEFAULT));
+  if (num_shards == 0) {
+    throw utils::Exception(PROP_SHARDS + " must be positive");
+  }
+  cache_ = new Cache(std::stoull(props_->GetProperty(PROP_CAPACITY, PROP_CAPACITY_DEFAULT)),
+                     num_shards);
+}
+
+void CacheDB::GetStats(std::vector<Field> &stats) {
+  {
+    const std::lock_guard<std::mutex> lock(mu_);
+    if (cache_) {
+      Cache::Stats cache_stats = cache_->GetStats();
+      const uint64_t lookups = cache_stats.hits + cache_stats.misses;
+      stats.push_back({"cache.hits", std::to_string(cache_stats.hits)});
+      stats.push_back({"cache.misses", std::to_string(cache_stats.misses)});
+      stats.push_back({"cache.hit_ratio",
+                       std::to_string(lookups ? double(cache_stats.hits) / lookups : 0.0)});
+      stats.push_back({"cache.usage", std::to_string(cache_stats.usage)});
+      stats.push_back({"cache.capacity", std::to_string(cache_->capacity())});
+      stats.push_back({"cache.entries", std::to_string(cache_stats.entries)});
+    }
+  }
+  db_->GetStats(stats);
+}
+
+DB::Status CacheDB::Fetch(const std::string &table, const std::string &key,
+                          std::shared_ptr<const Row> *row) {
+  const std::string cache_key = CacheKey(table, key);
+  uint64_t version = 0;
+  *row = cache_->Lookup(cache_key, &version);
+  if (*row) {
+    return kOK;
+  }
+  Row values;
+  Status s = db_->Read(table, key, nullptr, values);
+  if (s != kOK) {
+    return s;
+  }
+  *row = std::make_shared<const Row>(std::move(values));
+  cache_->Fill(cache_key, *row, version);
+  return kOK;
+}
+
+void CacheDB::Written(const std::string &cache_key, const std::vector<Field> &values,
+                      bool insert) {
+  cache_->EndWrite(cache_key, write_through_ ? &values : nullptr, insert);
+}
+
+DB::Status CacheDB::Read(const std::string &table, const std::string &key,
+                         const std::vector<std::string> *fields, std::vector<Field> &result) {
+  std::shared_ptr<const Row> row;
+  Status s = Fetch(table, key, &row);
+  if (s != kOK) {
+    return s;
+  }
+  ForEachField(*row, fields, [&result](const Field &field) { result.push_back(field); });
+  return kOK;
+}
+
+DB::Status CacheDB::ReadView(const std::string &table, const std::string &key,
+                             const std::vector<std::string> *fields, const RowVisitor &visitor) {
+  std::shared_ptr<const Row> row;
+  Status s = Fetch(table, key, &row);
+  if (s != kOK) {
+    return s;
+  }
+  std::vector<FieldView> views;
+  ForEachField(*row, fields, [&views](const Field &field) {
+    views.push_back({field.name, field.value});
+  });
+  visitor(views);
+  return kOK;
+}
+
+DB::Status CacheDB::Update(const std::string &table, const std::string &key,
+                           std::vector<Field> &values) {
+  const std::string cache_key = CacheKey(table, key);
+  cache_->BeginWrite(cache_key);
+  Status s = db_->Update(table, key, values);
+  if (s == kOK) {
+    Written(cache_key, values, false);
+  } else {
+    cache_->EndWrite(cache_key, nullptr, false);
+  }
+  return s;
+}
+
+DB::Status CacheDB::ReadModifyWrite(const std::string &table, const std::string &key,
+                                    const std::vector<std::string> *fields,
+                                    const RowVisitor &visitor, std::vector<Field> &values) {
+  // the binding reads and writes the record in one operation, which a read
+  // from the cache would split
+  const std::string cache_key = CacheKey(table, key);
+  cache_->BeginWrite(cache_key);
+  Status s = db_->ReadModifyWrite(table, key, fields, visitor, values);
+  if (s == kOK) {
+    Written(cache_key, values, false);
+  } else {
+    cache_->EndWrite(cache_key, nullptr, false);
+  }
+  return s;
+}
+
+DB::Status CacheDB::Insert(const std::string &table, const std::string &key,
+                           std::vector<Field> &values) {
+  const std::string cache_key = CacheKey(table, key);
+  cache_->BeginWrite(cache_key);
+  Status s = db_->Insert(table, key, values);
+  if (s == kOK) {
+    Written(cache_key, values, true);
+  } else {
+    cache_->EndWrite(cache_key, nullptr, false);
+  }
+  return s;
+}
+
+DB::Status CacheDB::Delete(const std::string &table, const std::string &key) {
+  const std::string cache_key = CacheKey(table, key);
+  cache_->BeginWrite(cache_key);
+  Status s = db_->Delete(table, key);
+  cache_->EndWrite(cache_key, nullptr, false);
+  return s;
+}
+
+DB::Status CacheDB::BeginTransaction(Transaction **txn) {
+  Transaction *db_txn;
+  Status s = db_->BeginTransaction(&db_txn);
+  if (s != kOK) {
+    return s;
+  }
+  *txn = new CacheTransaction(db_txn);
+  return kOK;
+}
+
+} // ycsbc
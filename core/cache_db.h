@@ -0,0 +1,125 @@
+//
+//  cache_db.h
+//  YCSB-cpp
+//
+
+#ifndef YCSB_C_CACHE_DB_H_
+#define YCSB_C_CACHE_DB_H_
+
+#include "db.h"
+#include "utils/properties.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ycsbc {
+
+///
+/// Use of the client cache during a phase.
+///
+struct CacheSummary {
+  // lookups of the phase
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  // at the end of the phase, capacity 0 if there is no cache
+  uint64_t usage = 0;
+  uint64_t capacity = 0;
+  uint64_t entries = 0;
+};
+
+///
+/// Client-side record cache in front of a binding, as in a cache-aside tier.
+/// Reads are served from an in-process LRU cache shared by all client
+/// threads and filled with the whole record on a miss. Writes go to the
+/// binding and then update the cached record (write-through) or drop it
+/// (invalidate); a record written by concurrent writes, or read from the
+/// binding while it is written, is dropped instead since the order of the
+/// writes is unknown. Scans bypass the cache. The cache lives as long as any
+/// instance, so it stays warm from the load phase to the run phase.
+///
+class CacheDB : public DB {
+ public:
+  explicit CacheDB(DB *db);
+  ~CacheDB();
+
+  ///
+  /// Whether the properties configure a cache in front of the binding.
+  ///
+  static bool Enabled(const utils::Properties &props);
+  ///
+  /// Returns the use of the cache since the previous call, or since it was
+  /// created.
+  ///
+  static CacheSummary TakePhaseSummary();
+
+  void Init();
+  void Cleanup() {
+    db_->Cleanup();
+  }
+  void FinishLoad() {
+    db_->FinishLoad();
+  }
+  void GetStats(std::vector<Field> &stats);
+  std::string GetDataPath() {
+    return db_->GetDataPath();
+  }
+
+  Status Read(const std::string &table, const std::string &key,
+              const std::vector<std::string> *fields, std::vector<Field> &result);
+  Status ReadView(const std::string &table, const std::string &key,
+                  const std::vector<std::string> *fields, const RowVisitor &visitor);
+  Status Scan(const std::string &table, const std::string &key, int len,
+              const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result) {
+    return db_->Scan(table, key, len, fields, result);
+  }
+  Status ScanView(const std::string &table, const std::string &key, int len,
+                  const std::vector<std::string> *fields, const ScanVisitor &visitor) {
+    return db_->ScanView(table, key, len, fields, visitor);
+  }
+  Status ScanRange(const std::string &table, const std::string &key, int len,
+                   const ScanBounds &bounds, const std::vector<std::string> *fields,
+                   const ScanVisitor &visitor) {
+    return db_->ScanRange(table, key, len, bounds, fields, visitor);
+  }
+  Status Update(const std::string &table, const std::string &key, std::vector<Field> &values);
+  Status ReadModifyWrite(const std::string &table, const std::string &key,
+                         const std::vector<std::string> *fields, const RowVisitor &visitor,
+                         std::vector<Field> &values);
+  Status Insert(const std::string &table, const std::string &key, std::vector<Field> &values);
+  Status Delete(const std::string &table, const std::string &key);
+
+  Status BeginTransaction(Transaction **txn);
+
+ private:
+  class Cache;
+  class CacheTransaction;
+  typedef std::vector<Field> Row;
+
+  ///
+  /// Looks up the record, reading all of its fields from the binding and
+  /// caching them on a miss.
+  ///
+  Status Fetch(const std::string &table, const std::string &key,
+               std::shared_ptr<const Row> *row);
+  ///
+  /// Applies the write policy to the cached record after values were
+  /// written to it, replacing the whole record if insert is set.
+  ///
+  void Written(const std::string &cache_key, const std::vector<Field> &values, bool insert);
+
+  DB *db_;
+
+  static Cache *cache_;
+  static bool write_through_;
+  static int ref_cnt_;
+  // lookups up to the previous TakePhaseSummary()
+  static uint64_t phase_hits_;
+  static uint64_t phase_misses_;
+  static std::mutex mu_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_CACHE_DB_H_
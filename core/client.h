@@ -10,38 +10,80 @@
 #define YCSB_C_CLIENT_H_
 
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include "db.h"
 #include "core_workload.h"
+#include "measurements.h"
 #include "utils/countdown_latch.h"
+#include "utils/perf_counters.h"
 #include "utils/rate_limit.h"
+#include "utils/timer.h"
 #include "utils/utils.h"
 
 namespace ycsbc {
 
-inline int ClientThread(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const int num_ops, bool is_loading,
-                        bool init_db, bool cleanup_db, utils::CountDownLatch *latch, utils::RateLimiter *rlim) {
+inline int ClientThread(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const int num_ops, uint64_t key_start,
+                        bool is_loading, bool init_db, bool cleanup_db, utils::CountDownLatch *latch,
+                        utils::RateLimiter *rlim, Measurements *measurements) {
 
   try {
     if (init_db) {
       db->Init();
     }
 
+    const bool breakdown = measurements->breakdown();
+    utils::LatencyTimer timer;
+
+    std::unique_ptr<utils::PerfCounters> perf;
+    if (measurements->perf_counters()) {
+      perf.reset(new utils::PerfCounters(measurements->perf_kernel()));
+      perf->Start();
+    }
+
     int ops = 0;
     for (int i = 0; i < num_ops; ++i) {
       if (rlim) {
+        if (breakdown) {
+          timer.Start();
+        }
         rlim->Consume(1);
+        if (breakdown) {
+          measurements->ReportStage(STAGE_THROTTLE, timer.End());
+        }
       }
 
-      if (is_loading) {
+      if (breakdown) {
+        timer.Start();
+      }
+      if (is_loading && wl->partitioned_inserts()) {
+        wl->DoInsert(*db, key_start + i);
+      } else if (is_loading) {
         wl->DoInsert(*db);
       } else {
         wl->DoTransaction(*db);
       }
+      if (breakdown) {
+        measurements->ReportStage(STAGE_OPERATION, timer.End());
+      }
       ops++;
     }
 
+    if (perf) {
+      perf->Stop();
+      for (int c = 0; c < utils::MAXPERFCOUNTER; c++) {
+        utils::PerfCounter counter = static_cast<utils::PerfCounter>(c);
+        if (perf->Available(counter)) {
+          measurements->ReportPerf(counter, perf->Read(counter), ops);
+        }
+      }
+    }
+
+    if (is_loading) {
+      db->FinishLoad();
+    }
+
     if (cleanup_db) {
       db->Cleanup();
     }
@@ -13,7 +13,9 @@
 #include "skewed_latest_generator.h"
 #include "const_generator.h"
 #include "core_workload.h"
+#include "measurements.h"
 #include "random_byte_generator.h"
+#include "utils/timer.h"
 #include "utils/utils.h"
 
 #include <algorithm>
@@ -23,6 +25,39 @@
 using ycsbc::CoreWorkload;
 using std::string;
 
+namespace {
+  // times a stage of the overhead breakdown while in scope, if enabled; the
+  // generator lock waits within it are reported as STAGE_GENERATOR_LOCK
+  class StageTimer {
+   public:
+    StageTimer(ycsbc::Measurements *measurements, ycsbc::Stage stage)
+        : measurements_(measurements && measurements->breakdown() ? measurements : nullptr),
+          stage_(stage) {
+      if (measurements_) {
+        timer_.Start();
+      }
+    }
+    ~StageTimer() {
+      if (measurements_) {
+        uint64_t elapsed = timer_.End();
+        uint64_t wait = ycsbc::GeneratorLock::TakeWait();
+        measurements_->ReportStage(ycsbc::STAGE_GENERATOR_LOCK, wait);
+        measurements_->ReportStage(stage_, elapsed > wait ? elapsed - wait : 0);
+      }
+    }
+
+   private:
+    ycsbc::Measurements *measurements_;
+    ycsbc::Stage stage_;
+    ycsbc::utils::LatencyTimer timer_;
+  };
+} // anonymous
+
+void CoreWorkload::set_measurements(Measurements *measurements) {
+  measurements_ = measurements;
+  GeneratorLock::EnableTiming(measurements && measurements->breakdown());
+}
+
 const char *ycsbc::kOperationString[ycsbc::MAXOPTYPE] = {
   "INSERT",
   "READ",
@@ -30,12 +65,18 @@ const char *ycsbc::kOperationString[ycsbc::MAXOPTYPE] = {
   "SCAN",
   "READMODIFYWRITE",
   "DELETE",
+  "TXN",
   "INSERT-FAILED",
   "READ-FAILED",
   "UPDATE-FAILED",
   "SCAN-FAILED",
   "READMODIFYWRITE-FAILED",
-  "DELETE-FAILED"
+  "DELETE-FAILED",
+  "TXN-FAILED",
+  "TXN-COMMIT",
+  "TXN-ABORT",
+  "TXN-RETRY",
+  "TXN-PARTIAL"
 };
 
 const string CoreWorkload::TABLENAME_PROPERTY = "table";
@@ -53,6 +94,9 @@ const string CoreWorkload::FIELD_LENGTH_DEFAULT = "100";
 const string CoreWorkload::READ_ALL_FIELDS_PROPERTY = "readallfields";
 const string CoreWorkload::READ_ALL_FIELDS_DEFAULT = "true";
 
+const string CoreWorkload::ZERO_COPY_READ_PROPERTY = "zerocopyread";
+const string CoreWorkload::ZERO_COPY_READ_DEFAULT = "false";
+
 const string CoreWorkload::WRITE_ALL_FIELDS_PROPERTY = "writeallfields";
 const string CoreWorkload::WRITE_ALL_FIELDS_DEFAULT = "false";
 
@@ -71,6 +115,18 @@ const string CoreWorkload::SCAN_PROPORTION_DEFAULT = "0.0";
 const string CoreWorkload::READMODIFYWRITE_PROPORTION_PROPERTY = "readmodifywriteproportion";
 const string CoreWorkload::READMODIFYWRITE_PROPORTION_DEFAULT = "0.0";
 
+const string CoreWorkload::TXN_PROPORTION_PROPERTY = "txnproportion";
+const string CoreWorkload::TXN_PROPORTION_DEFAULT = "0.0";
+
+const string CoreWorkload::TXN_READ_COUNT_PROPERTY = "txnreadcount";
+const string CoreWorkload::TXN_READ_COUNT_DEFAULT = "2";
+
+const string CoreWorkload::TXN_WRITE_COUNT_PROPERTY = "txnwritecount";
+const string CoreWorkload::TXN_WRITE_COUNT_DEFAULT = "2";
+
+const string CoreWorkload::TXN_MAX_RETRIES_PROPERTY = "txnmaxretries";
+const string CoreWorkload::TXN_MAX_RETRIES_DEFAULT = "10";
+
 const string CoreWorkload::REQUEST_DISTRIBUTION_PROPERTY = "requestdistribution";
 const string CoreWorkload::REQUEST_DISTRIBUTION_DEFAULT = "uniform";
 
@@ -86,12 +142,21 @@ const string CoreWorkload::MAX_SCAN_LENGTH_DEFAULT = "1000";
 const string CoreWorkload::SCAN_LENGTH_DISTRIBUTION_PROPERTY = "scanlengthdistribution";
 const string CoreWorkload::SCAN_LENGTH_DISTRIBUTION_DEFAULT = "uniform";
 
+const string CoreWorkload::REVERSE_SCAN_PROPORTION_PROPERTY = "reversescanproportion";
+const string CoreWorkload::REVERSE_SCAN_PROPORTION_DEFAULT = "0.0";
+
+const string CoreWorkload::BOUNDED_SCAN_PROPERTY = "boundedscan";
+const string CoreWorkload::BOUNDED_SCAN_DEFAULT = "false";
+
 const string CoreWorkload::INSERT_ORDER_PROPERTY = "insertorder";
 const string CoreWorkload::INSERT_ORDER_DEFAULT = "hashed";
 
 const string CoreWorkload::INSERT_START_PROPERTY = "insertstart";
 const string CoreWorkload::INSERT_START_DEFAULT = "0";
 
+const string CoreWorkload::INSERT_PARTITIONED_PROPERTY = "insertpartitioned";
+const string CoreWorkload::INSERT_PARTITIONED_DEFAULT = "false";
+
 const string CoreWorkload::RECORD_COUNT_PROPERTY = "recordcount";
 const string CoreWorkload::OPERATION_COUNT_PROPERTY = "operationcount";
 
@@ -119,6 +184,11 @@ void CoreWorkload::Init(const utils::Properties &p) {
                                                    SCAN_PROPORTION_DEFAULT));
   double readmodifywrite_proportion = std::stod(p.GetProperty(
       READMODIFYWRITE_PROPORTION_PROPERTY, READMODIFYWRITE_PROPORTION_DEFAULT));
+  double txn_proportion = std::stod(p.GetProperty(TXN_PROPORTION_PROPERTY,
+                                                  TXN_PROPORTION_DEFAULT));
+  txn_read_count_ = std::stoi(p.GetProperty(TXN_READ_COUNT_PROPERTY, TXN_READ_COUNT_DEFAULT));
+  txn_write_count_ = std::stoi(p.GetProperty(TXN_WRITE_COUNT_PROPERTY, TXN_WRITE_COUNT_DEFAULT));
+  txn_max_retries_ = std::stoi(p.GetProperty(TXN_MAX_RETRIES_PROPERTY, TXN_MAX_RETRIES_DEFAULT));
 
   record_count_ = std::stoi(p.GetProperty(RECORD_COUNT_PROPERTY));
   std::string request_dist = p.GetProperty(REQUEST_DISTRIBUTION_PROPERTY,
@@ -127,7 +197,10 @@ void CoreWorkload::Init(const utils::Properties &p) {
   int max_scan_len = std::stoi(p.GetProperty(MAX_SCAN_LENGTH_PROPERTY, MAX_SCAN_LENGTH_DEFAULT));
   std::string scan_len_dist = p.GetProperty(SCAN_LENGTH_DISTRIBUTION_PROPERTY,
                                             SCAN_LENGTH_DISTRIBUTION_DEFAULT);
-  int insert_start = std::stoi(p.GetProperty(INSERT_START_PROPERTY, INSERT_START_DEFAULT));
+  reverse_scan_proportion_ = std::stod(p.GetProperty(REVERSE_SCAN_PROPORTION_PROPERTY,
+                                                     REVERSE_SCAN_PROPORTION_DEFAULT));
+  bounded_scans_ = utils::StrToBool(p.GetProperty(BOUNDED_SCAN_PROPERTY, BOUNDED_SCAN_DEFAULT));
+  insert_start_ = std::stoull(p.GetProperty(INSERT_START_PROPERTY, INSERT_START_DEFAULT));
 
   zero_padding_ = std::stoi(p.GetProperty(ZERO_PADDING_PROPERTY, ZERO_PADDING_DEFAULT));
 
@@ -135,12 +208,40 @@ void CoreWorkload::Init(const utils::Properties &p) {
                                                     READ_ALL_FIELDS_DEFAULT));
   write_all_fields_ = utils::StrToBool(p.GetProperty(WRITE_ALL_FIELDS_PROPERTY,
                                                      WRITE_ALL_FIELDS_DEFAULT));
+  zero_copy_read_ = utils::StrToBool(p.GetProperty(ZERO_COPY_READ_PROPERTY,
+                                                   ZERO_COPY_READ_DEFAULT));
 
   if (p.GetProperty(INSERT_ORDER_PROPERTY, INSERT_ORDER_DEFAULT) == "hashed") {
     ordered_inserts_ = false;
   } else {
     ordered_inserts_ = true;
   }
+  partitioned_inserts_ = utils::StrToBool(p.GetProperty(INSERT_PARTITIONED_PROPERTY,
+                                                        INSERT_PARTITIONED_DEFAULT));
+  // hashed key names would scatter the sequential ranges of the threads, and
+  // short padded ones would interleave them
+  if (partitioned_inserts_) {
+    const uint64_t max_key = insert_start_ + record_count_;
+    if (!ordered_inserts_ ||
+        zero_padding_ < static_cast<int>(std::to_string(max_key).size())) {
+      throw utils::Exception(INSERT_PARTITIONED_PROPERTY + " requires " + INSERT_ORDER_PROPERTY +
+                             "=ordered and a " + ZERO_PADDING_PROPERTY + " of at least " +
+                             std::to_string(std::to_string(max_key).size()));
+    }
+  }
+  // the end key of a bounded scan is only at the right position if key names
+  // sort like the key numbers, up to the largest end key of the run
+  if (bounded_scans_) {
+    const uint64_t max_key = insert_start_ + record_count_ +
+                             std::stoull(p.GetProperty(OPERATION_COUNT_PROPERTY, "0")) +
+                             max_scan_len;
+    if (!ordered_inserts_ ||
+        zero_padding_ < static_cast<int>(std::to_string(max_key).size())) {
+      throw utils::Exception(BOUNDED_SCAN_PROPERTY + " requires " + INSERT_ORDER_PROPERTY +
+                             "=ordered and a " + ZERO_PADDING_PROPERTY + " of at least " +
+                             std::to_string(std::to_string(max_key).size()));
+    }
+  }
 
 
   if (read_proportion > 0) {
@@ -158,8 +259,11 @@ void CoreWorkload::Init(const utils::Properties &p) {
   if (readmodifywrite_proportion > 0) {
     op_chooser_.AddValue(READMODIFYWRITE, readmodifywrite_proportion);
   }
+  if (txn_proportion > 0) {
+    op_chooser_.AddValue(TXN, txn_proportion);
+  }
 
-  insert_key_sequence_ = new CounterGenerator(insert_start);
+  insert_key_sequence_ = new CounterGenerator(insert_start_);
   transaction_insert_key_sequence_ = new AcknowledgedCounterGenerator(record_count_);
 
   if (request_dist == "uniform") {
@@ -175,12 +279,15 @@ void CoreWorkload::Init(const utils::Properties &p) {
     int new_keys = (int)(op_count * insert_proportion * 2); // a fudge factor
     if (p.ContainsKey(ZIPFIAN_CONST_PROPERTY)) {
       double zipfian_const = std::stod(p.GetProperty(ZIPFIAN_CONST_PROPERTY));
-      key_chooser_ = new ScrambledZipfianGenerator(0, record_count_ + new_keys - 1, zipfian_const);
+      ranked_key_chooser_ = new ScrambledZipfianGenerator(0, record_count_ + new_keys - 1,
+                                                          zipfian_const);
     } else {
-      key_chooser_ = new ScrambledZipfianGenerator(record_count_ + new_keys);
+      ranked_key_chooser_ = new ScrambledZipfianGenerator(record_count_ + new_keys);
     }
+    key_chooser_ = ranked_key_chooser_;
   } else if (request_dist == "latest") {
-    key_chooser_ = new SkewedLatestGenerator(*transaction_insert_key_sequence_);
+    ranked_key_chooser_ = new SkewedLatestGenerator(*transaction_insert_key_sequence_);
+    key_chooser_ = ranked_key_chooser_;
   } else {
     throw utils::Exception("Unknown request distribution: " + request_dist);
   }
@@ -212,40 +319,71 @@ ycsbc::Generator<uint64_t> *CoreWorkload::GetFieldLenGenerator(
   }
 }
 
+void CoreWorkload::AssignRow(const std::vector<DB::FieldView> &row,
+                             std::vector<DB::Field> &fields) {
+  fields.resize(row.size());
+  for (size_t i = 0; i < row.size(); i++) {
+    fields[i].name.assign(row[i].name);
+    fields[i].value.assign(row[i].value);
+  }
+}
+
+CoreWorkload::OpBuffers &CoreWorkload::ThreadBuffers() {
+  thread_local OpBuffers buffers;
+  return buffers;
+}
+
 std::string CoreWorkload::BuildKeyName(uint64_t key_num) {
+  std::string key;
+  BuildKeyName(key_num, key);
+  return key;
+}
+
+void CoreWorkload::BuildKeyName(uint64_t key_num, std::string &key) {
+  StageTimer timer(measurements_, STAGE_BUILD_KEY);
   if (!ordered_inserts_) {
     key_num = utils::Hash(key_num);
   }
-  std::string prekey = "user";
   std::string value = std::to_string(key_num);
   int fill = std::max(0, zero_padding_ - static_cast<int>(value.size()));
-  return prekey.append(fill, '0').append(value);
+  key.assign("user").append(fill, '0').append(value);
 }
 
 void CoreWorkload::BuildValues(std::vector<ycsbc::DB::Field> &values) {
+  StageTimer timer(measurements_, STAGE_BUILD_VALUES);
+  values.resize(field_count_);
   for (int i = 0; i < field_count_; ++i) {
-    values.push_back(DB::Field());
-    ycsbc::DB::Field &field = values.back();
-    field.name.append(field_prefix_).append(std::to_string(i));
-    uint64_t len = field_len_generator_->Next();
-    field.value.reserve(len);
-    RandomByteGenerator byte_generator;
-    std::generate_n(std::back_inserter(field.value), len, [&]() { return byte_generator.Next(); } );
+    ycsbc::DB::Field &field = values[i];
+    field.name.assign(field_prefix_).append(std::to_string(i));
+    FillValue(field.value);
   }
 }
 
 void CoreWorkload::BuildSingleValue(std::vector<ycsbc::DB::Field> &values) {
-  values.push_back(DB::Field());
-  ycsbc::DB::Field &field = values.back();
-  field.name.append(NextFieldName());
-  uint64_t len = field_len_generator_->Next();
-  field.value.reserve(len);
+  StageTimer timer(measurements_, STAGE_BUILD_VALUES);
+  values.resize(1);
+  ycsbc::DB::Field &field = values[0];
+  field.name = NextFieldName();
+  FillValue(field.value);
+}
+
+void CoreWorkload::FillValue(std::string &value) {
+  value.resize(field_len_generator_->Next());
   RandomByteGenerator byte_generator;
-  std::generate_n(std::back_inserter(field.value), len, [&]() { return byte_generator.Next(); } );
+  std::generate(value.begin(), value.end(), [&]() { return byte_generator.Next(); });
 }
 
 uint64_t CoreWorkload::NextTransactionKeyNum() {
+  StageTimer timer(measurements_, STAGE_KEY_CHOICE);
   uint64_t key_num;
+  if (ranked_key_chooser_ && measurements_ && measurements_->key_buckets()) {
+    double rank;
+    do {
+      key_num = ranked_key_chooser_->Next(&rank);
+    } while (key_num > transaction_insert_key_sequence_->Last());
+    measurements_->SetKeyRank(rank);
+    return key_num;
+  }
   do {
     key_num = key_chooser_->Next();
   } while (key_num > transaction_insert_key_sequence_->Last());
@@ -257,14 +395,27 @@ std::string CoreWorkload::NextFieldName() {
 }
 
 bool CoreWorkload::DoInsert(DB &db) {
-  const std::string key = BuildKeyName(insert_key_sequence_->Next());
-  std::vector<DB::Field> fields;
-  BuildValues(fields);
-  return db.Insert(table_name_, key, fields) == DB::kOK;
+  uint64_t key_num;
+  {
+    StageTimer timer(measurements_, STAGE_KEY_CHOICE);
+    key_num = insert_key_sequence_->Next();
+  }
+  return DoInsert(db, key_num);
+}
+
+bool CoreWorkload::DoInsert(DB &db, uint64_t key_num) {
+  OpBuffers &buffers = ThreadBuffers();
+  BuildKeyName(key_num, buffers.key);
+  BuildValues(buffers.values);
+  return db.Insert(table_name_, buffers.key, buffers.values) == DB::kOK;
 }
 
 bool CoreWorkload::DoTransaction(DB &db) {
   DB::Status status;
+  if (measurements_ && measurements_->key_buckets()) {
+    // operations that do not pick an existing key are not attributed
+    measurements_->ClearKeyRank();
+  }
   switch (op_chooser_.Next()) {
     case READ:
       status = TransactionRead(db);
@@ -281,81 +432,150 @@ bool CoreWorkload::DoTransaction(DB &db) {
     case READMODIFYWRITE:
       status = TransactionReadModifyWrite(db);
       break;
+    case TXN:
+      status = TransactionMultiKey(db);
+      break;
     default:
       throw utils::Exception("Operation request is not recognized!");
   }
   return (status == DB::kOK);
 }
 
+DB::Status CoreWorkload::ReadRecord(DB &db, const std::string &key,
+                                    const std::vector<std::string> *fields) {
+  if (zero_copy_read()) {
+    // the record is not used, so nothing is copied out of the views
+    return db.ReadView(table_name_, key, fields, [](const std::vector<DB::FieldView> &) {});
+  }
+  std::vector<DB::Field> &result = ThreadBuffers().result;
+  return db.ReadView(table_name_, key, fields, [&result](const std::vector<DB::FieldView> &row) {
+    AssignRow(row, result);
+  });
+}
+
 DB::Status CoreWorkload::TransactionRead(DB &db) {
-  uint64_t key_num = NextTransactionKeyNum();
-  const std::string key = BuildKeyName(key_num);
-  std::vector<DB::Field> result;
+  OpBuffers &buffers = ThreadBuffers();
+  BuildKeyName(NextTransactionKeyNum(), buffers.key);
   if (!read_all_fields()) {
-    std::vector<std::string> fields;
-    fields.push_back(NextFieldName());
-    return db.Read(table_name_, key, &fields, result);
+    buffers.fields.resize(1);
+    buffers.fields[0] = NextFieldName();
+    return ReadRecord(db, buffers.key, &buffers.fields);
   } else {
-    return db.Read(table_name_, key, NULL, result);
+    return ReadRecord(db, buffers.key, NULL);
   }
 }
 
 DB::Status CoreWorkload::TransactionReadModifyWrite(DB &db) {
-  uint64_t key_num = NextTransactionKeyNum();
-  const std::string key = BuildKeyName(key_num);
-  std::vector<DB::Field> result;
-
+  OpBuffers &buffers = ThreadBuffers();
+  BuildKeyName(NextTransactionKeyNum(), buffers.key);
+  const std::vector<std::string> *fields = NULL;
   if (!read_all_fields()) {
-    std::vector<std::string> fields;
-    fields.push_back(NextFieldName());
-    db.Read(table_name_, key, &fields, result);
-  } else {
-    db.Read(table_name_, key, NULL, result);
+    buffers.fields.resize(1);
+    buffers.fields[0] = NextFieldName();
+    fields = &buffers.fields;
   }
-
-  std::vector<DB::Field> values;
   if (write_all_fields()) {
-    BuildValues(values);
+    BuildValues(buffers.values);
   } else {
-    BuildSingleValue(values);
+    BuildSingleValue(buffers.values);
+  }
+  if (zero_copy_read()) {
+    return db.ReadModifyWrite(table_name_, buffers.key, fields,
+                              [](const std::vector<DB::FieldView> &) {}, buffers.values);
   }
-  return db.Update(table_name_, key, values);
+  std::vector<DB::Field> &result = buffers.result;
+  return db.ReadModifyWrite(table_name_, buffers.key, fields,
+                            [&result](const std::vector<DB::FieldView> &row) {
+    AssignRow(row, result);
+  }, buffers.values);
 }
 
 DB::Status CoreWorkload::TransactionScan(DB &db) {
+  OpBuffers &buffers = ThreadBuffers();
   uint64_t key_num = NextTransactionKeyNum();
-  const std::string key = BuildKeyName(key_num);
+  BuildKeyName(key_num, buffers.key);
   int len = scan_len_chooser_->Next();
-  std::vector<std::vector<DB::Field>> result;
+  const std::vector<std::string> *fields = NULL;
   if (!read_all_fields()) {
-    std::vector<std::string> fields;
-    fields.push_back(NextFieldName());
-    return db.Scan(table_name_, key, len, &fields, result);
-  } else {
-    return db.Scan(table_name_, key, len, NULL, result);
+    buffers.fields.resize(1);
+    buffers.fields[0] = NextFieldName();
+    fields = &buffers.fields;
   }
+  DB::ScanBounds &bounds = buffers.scan_bounds;
+  bounds.reverse = reverse_scan_proportion_ > 0 &&
+                   utils::ThreadLocalRandomDouble() < reverse_scan_proportion_;
+  bounds.end_key.clear();
+  if (bounded_scans_ && (!bounds.reverse || key_num >= static_cast<uint64_t>(len))) {
+    BuildKeyName(bounds.reverse ? key_num - len : key_num + len, bounds.end_key);
+  }
+  if (zero_copy_read()) {
+    return db.ScanRange(table_name_, buffers.key, len, bounds, fields,
+                        [](std::string_view, const std::vector<DB::FieldView> &) { return true; });
+  }
+  std::vector<std::vector<DB::Field>> &rows = buffers.rows;
+  size_t &row_count = buffers.row_count;
+  row_count = 0;
+  return db.ScanRange(table_name_, buffers.key, len, bounds, fields,
+                      [&rows, &row_count](std::string_view, const std::vector<DB::FieldView> &row) {
+    if (row_count == rows.size()) {
+      rows.emplace_back();
+    }
+    AssignRow(row, rows[row_count++]);
+    return true;
+  });
 }
 
 DB::Status CoreWorkload::TransactionUpdate(DB &db) {
-  uint64_t key_num = NextTransactionKeyNum();
-  const std::string key = BuildKeyName(key_num);
-  std::vector<DB::Field> values;
+  OpBuffers &buffers = ThreadBuffers();
+  BuildKeyName(NextTransactionKeyNum(), buffers.key);
   if (write_all_fields()) {
-    BuildValues(values);
+    BuildValues(buffers.values);
   } else {
-    BuildSingleValue(values);
+    BuildSingleValue(buffers.values);
   }
-  return db.Update(table_name_, key, values);
+  return db.Update(table_name_, buffers.key, buffers.values);
 }
 
 DB::Status CoreWorkload::TransactionInsert(DB &db) {
-  uint64_t key_num = transaction_insert_key_sequence_->Next();
-  const std::string key = BuildKeyName(key_num);
-  std::vector<DB::Field> values;
-  BuildValues(values);
-  DB::Status s = db.Insert(table_name_, key, values);
+  OpBuffers &buffers = ThreadBuffers();
+  uint64_t key_num;
+  {
+    StageTimer timer(measurements_, STAGE_KEY_CHOICE);
+    key_num = transaction_insert_key_sequence_->Next();
+  }
+  BuildKeyName(key_num, buffers.key);
+  BuildValues(buffers.values);
+  DB::Status s = db.Insert(table_name_, buffers.key, buffers.values);
+  StageTimer timer(measurements_, STAGE_KEY_ACK);
   transaction_insert_key_sequence_->Acknowledge(key_num);
   return s;
 }
 
+DB::Status CoreWorkload::TransactionMultiKey(DB &db) {
+  OpBuffers &buffers = ThreadBuffers();
+  buffers.read_keys.resize(txn_read_count_);
+  for (std::string &key : buffers.read_keys) {
+    BuildKeyName(NextTransactionKeyNum(), key);
+  }
+  buffers.write_keys.resize(txn_write_count_);
+  buffers.write_values.resize(txn_write_count_);
+  for (int i = 0; i < txn_write_count_; i++) {
+    BuildKeyName(NextTransactionKeyNum(), buffers.write_keys[i]);
+    if (write_all_fields()) {
+      BuildValues(buffers.write_values[i]);
+    } else {
+      BuildSingleValue(buffers.write_values[i]);
+    }
+  }
+  if (!read_all_fields()) {
+    buffers.fields.resize(1);
+    buffers.fields[0] = NextFieldName();
+    return db.ExecuteTransaction(table_name_, buffers.read_keys, &buffers.fields,
+                                 buffers.write_keys, buffers.write_values, txn_max_retries_);
+  } else {
+    return db.ExecuteTransaction(table_name_, buffers.read_keys, NULL, buffers.write_keys,
+                                 buffers.write_values, txn_max_retries_);
+  }
+}
+
 } // ycsbc
@@ -22,6 +22,8 @@
 
 namespace ycsbc {
 
+class Measurements;
+
 enum Operation {
   INSERT = 0,
   READ,
@@ -29,12 +31,19 @@ enum Operation {
   SCAN,
   READMODIFYWRITE,
   DELETE,
+  TXN,
   INSERT_FAILED,
   READ_FAILED,
   UPDATE_FAILED,
   SCAN_FAILED,
   READMODIFYWRITE_FAILED,
   DELETE_FAILED,
+  TXN_FAILED,
+  // per-attempt measurements of TXN, not counted as operations
+  TXN_COMMIT,
+  TXN_ABORT,
+  TXN_RETRY,
+  TXN_PARTIAL,
   MAXOPTYPE
 };
 
@@ -74,6 +83,13 @@ class CoreWorkload {
   static const std::string READ_ALL_FIELDS_PROPERTY;
   static const std::string READ_ALL_FIELDS_DEFAULT;
 
+  ///
+  /// The name of the property for deciding whether reads use DB::ReadView()
+  /// (true), which does not copy the record, or DB::Read() (false).
+  ///
+  static const std::string ZERO_COPY_READ_PROPERTY;
+  static const std::string ZERO_COPY_READ_DEFAULT;
+
   ///
   /// The name of the property for deciding whether to write one field (false)
   /// or all fields (true) of a record.
@@ -112,6 +128,30 @@ class CoreWorkload {
   static const std::string READMODIFYWRITE_PROPORTION_PROPERTY;
   static const std::string READMODIFYWRITE_PROPORTION_DEFAULT;
 
+  ///
+  /// The name of the property for the proportion of multi-key transactions.
+  ///
+  static const std::string TXN_PROPORTION_PROPERTY;
+  static const std::string TXN_PROPORTION_DEFAULT;
+
+  ///
+  /// The name of the property for the number of records read by a multi-key transaction.
+  ///
+  static const std::string TXN_READ_COUNT_PROPERTY;
+  static const std::string TXN_READ_COUNT_DEFAULT;
+
+  ///
+  /// The name of the property for the number of records written by a multi-key transaction.
+  ///
+  static const std::string TXN_WRITE_COUNT_PROPERTY;
+  static const std::string TXN_WRITE_COUNT_DEFAULT;
+
+  ///
+  /// The name of the property for the number of retries of an aborted transaction.
+  ///
+  static const std::string TXN_MAX_RETRIES_PROPERTY;
+  static const std::string TXN_MAX_RETRIES_DEFAULT;
+
   ///
   /// The name of the property for the the distribution of request keys.
   /// Options are "uniform", "zipfian" and "latest".
@@ -144,6 +184,20 @@ class CoreWorkload {
   static const std::string SCAN_LENGTH_DISTRIBUTION_PROPERTY;
   static const std::string SCAN_LENGTH_DISTRIBUTION_DEFAULT;
 
+  ///
+  /// The name of the property for the proportion of scans that run in
+  /// reverse from their start key.
+  ///
+  static const std::string REVERSE_SCAN_PROPORTION_PROPERTY;
+  static const std::string REVERSE_SCAN_PROPORTION_DEFAULT;
+
+  ///
+  /// The name of the property for whether a scan of n records ends before
+  /// the key of the record n key numbers away from its start key.
+  ///
+  static const std::string BOUNDED_SCAN_PROPERTY;
+  static const std::string BOUNDED_SCAN_DEFAULT;
+
   ///
   /// The name of the property for the order to insert records.
   /// Options are "ordered" or "hashed".
@@ -154,6 +208,14 @@ class CoreWorkload {
   static const std::string INSERT_START_PROPERTY;
   static const std::string INSERT_START_DEFAULT;
 
+  ///
+  /// The name of the property for deciding whether each client thread loads
+  /// its own contiguous key range (true) or all threads draw keys from one
+  /// shared sequence (false).
+  ///
+  static const std::string INSERT_PARTITIONED_PROPERTY;
+  static const std::string INSERT_PARTITIONED_DEFAULT;
+
   static const std::string RECORD_COUNT_PROPERTY;
   static const std::string OPERATION_COUNT_PROPERTY;
 
@@ -175,16 +237,34 @@ class CoreWorkload {
   virtual void Init(const utils::Properties &p);
 
   virtual bool DoInsert(DB &db);
+  ///
+  /// Inserts the record of the given key number, used when client threads
+  /// load partitioned key ranges.
+  ///
+  virtual bool DoInsert(DB &db, uint64_t key_num);
   virtual bool DoTransaction(DB &db);
 
   bool read_all_fields() const { return read_all_fields_; }
+  bool zero_copy_read() const { return zero_copy_read_; }
   bool write_all_fields() const { return write_all_fields_; }
+  bool partitioned_inserts() const { return partitioned_inserts_; }
+  uint64_t insert_start() const { return insert_start_; }
+
+  ///
+  /// Measurements that receive the stage times of the overhead breakdown
+  /// and the popularity of the keys operated on.
+  ///
+  void set_measurements(Measurements *measurements);
 
   CoreWorkload() :
-      field_count_(0), read_all_fields_(false), write_all_fields_(false),
-      field_len_generator_(nullptr), key_chooser_(nullptr), field_chooser_(nullptr),
-      scan_len_chooser_(nullptr), insert_key_sequence_(nullptr),
-      transaction_insert_key_sequence_(nullptr), ordered_inserts_(true), record_count_(0) {
+      field_count_(0), read_all_fields_(false), zero_copy_read_(false), write_all_fields_(false),
+      field_len_generator_(nullptr), key_chooser_(nullptr), ranked_key_chooser_(nullptr),
+      field_chooser_(nullptr),
+      scan_len_chooser_(nullptr), reverse_scan_proportion_(0), bounded_scans_(false),
+      insert_key_sequence_(nullptr),
+      transaction_insert_key_sequence_(nullptr), ordered_inserts_(true),
+      partitioned_inserts_(false), insert_start_(0), record_count_(0), txn_read_count_(0),
+      txn_write_count_(0), txn_max_retries_(0), measurements_(nullptr) {
   }
 
   virtual ~CoreWorkload() {
@@ -197,35 +277,78 @@ class CoreWorkload {
   }
 
  protected:
+  ///
+  /// Per-thread buffers that operations clear and refill instead of
+  /// allocating new ones, so that their capacity and that of the strings
+  /// they hold is reused.
+  ///
+  struct OpBuffers {
+    std::string key;
+    std::vector<std::string> fields;
+    std::vector<DB::Field> values;
+    // fields of the last record read, valid if it was found
+    std::vector<DB::Field> result;
+    // the first row_count rows hold the records of the last scan, the ones
+    // after them are kept for their buffers
+    std::vector<std::vector<DB::Field>> rows;
+    size_t row_count = 0;
+    DB::ScanBounds scan_bounds;
+    std::vector<std::string> read_keys;
+    std::vector<std::string> write_keys;
+    std::vector<std::vector<DB::Field>> write_values;
+  };
+  static OpBuffers &ThreadBuffers();
+
   static Generator<uint64_t> *GetFieldLenGenerator(const utils::Properties &p);
   std::string BuildKeyName(uint64_t key_num);
+  void BuildKeyName(uint64_t key_num, std::string &key);
+  ///
+  /// Replace the contents of values, reusing its fields.
+  ///
   void BuildValues(std::vector<DB::Field> &values);
   void BuildSingleValue(std::vector<DB::Field> &update);
+  ///
+  /// Replace the contents of fields with copies of row, reusing its fields.
+  ///
+  static void AssignRow(const std::vector<DB::FieldView> &row, std::vector<DB::Field> &fields);
+  void FillValue(std::string &value);
 
   uint64_t NextTransactionKeyNum();
   std::string NextFieldName();
 
+  DB::Status ReadRecord(DB &db, const std::string &key, const std::vector<std::string> *fields);
   DB::Status TransactionRead(DB &db);
   DB::Status TransactionReadModifyWrite(DB &db);
   DB::Status TransactionScan(DB &db);
   DB::Status TransactionUpdate(DB &db);
   DB::Status TransactionInsert(DB &db);
+  DB::Status TransactionMultiKey(DB &db);
 
   std::string table_name_;
   int field_count_;
   std::string field_prefix_;
   bool read_all_fields_;
+  bool zero_copy_read_;
   bool write_all_fields_;
   Generator<uint64_t> *field_len_generator_;
   DiscreteGenerator<Operation> op_chooser_;
   Generator<uint64_t> *key_chooser_; // transaction key gen
+  RankedGenerator *ranked_key_chooser_; // key_chooser_ if it is skewed
   Generator<uint64_t> *field_chooser_;
   Generator<uint64_t> *scan_len_chooser_;
+  double reverse_scan_proportion_;
+  bool bounded_scans_;
   CounterGenerator *insert_key_sequence_; // load insert key gen
   AcknowledgedCounterGenerator *transaction_insert_key_sequence_; // transaction insert key gen
   bool ordered_inserts_;
+  bool partitioned_inserts_;
+  uint64_t insert_start_;
   size_t record_count_;
   int zero_padding_;
+  int txn_read_count_;
+  int txn_write_count_;
+  int txn_max_retries_;
+  Measurements *measurements_;
 };
 
 } // ycsbc
@@ -11,8 +11,10 @@
 
 #include "utils/properties.h"
 
-#include <vector>
+#include <functional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace ycsbc {
 
@@ -26,11 +28,77 @@ class DB {
     std::string name;
     std::string value;
   };
+  ///
+  /// Field of a record in memory owned by the DB, valid only for the call it
+  /// is passed to.
+  ///
+  struct FieldView {
+    std::string_view name;
+    std::string_view value;
+  };
+  typedef std::function<void(const std::vector<FieldView> &)> RowVisitor;
+  ///
+  /// Called with the key and fields of each scanned record, returns false to
+  /// end the scan. The key is empty if the binding does not provide it.
+  ///
+  typedef std::function<bool(std::string_view, const std::vector<FieldView> &)> ScanVisitor;
+  ///
+  /// Where a ScanRange() goes from its start key.
+  ///
+  struct ScanBounds {
+    // key at which the scan stops, excluded; empty for no bound
+    std::string end_key;
+    // read the keys at or before the start key in descending order
+    bool reverse = false;
+  };
   enum Status {
     kOK = 0,
     kError,
     kNotFound,
-    kNotImplemented
+    kNotImplemented,
+    kAborted
+  };
+  ///
+  /// Interactive transaction on a DB instance, created by BeginTransaction().
+  /// Operations return kAborted when the transaction lost a conflict, after
+  /// which it must be rolled back.
+  ///
+  class Transaction {
+   public:
+    virtual Status Read(const std::string &table, const std::string &key,
+                        const std::vector<std::string> *fields, std::vector<Field> &result) = 0;
+    virtual Status Update(const std::string &table, const std::string &key,
+                          std::vector<Field> &values) = 0;
+    ///
+    /// Commits the transaction. On failure the transaction is rolled back.
+    ///
+    virtual Status Commit() = 0;
+    virtual void Rollback() = 0;
+    ///
+    /// Whether a failed Commit() left part of the updates committed, after
+    /// which the transaction must not be retried.
+    ///
+    virtual bool PartiallyCommitted() const { return false; }
+    virtual ~Transaction() { }
+  };
+  ///
+  /// Callbacks of ExecuteTransaction() for each attempt, used to measure
+  /// the attempts without a second copy of the retry loop.
+  ///
+  class TransactionHooks {
+   public:
+    virtual void BeginAttempt() { }
+    ///
+    /// Called with each record read by the attempt.
+    ///
+    virtual void RecordRead(const std::string &key, const std::vector<Field> &result) { }
+    virtual void BeginCommit() { }
+    virtual void EndCommit(Status s, bool partial) { }
+    ///
+    /// Called when an attempt ends, attempt counting from 0.
+    ///
+    virtual void EndAttempt(int attempt, Status s) { }
+    virtual ~TransactionHooks() { }
   };
   ///
   /// Initializes any state for accessing this DB.
@@ -41,6 +109,24 @@ class DB {
   ///
   virtual void Cleanup() { }
   ///
+  /// Called by each client thread after it has issued all of its inserts
+  /// in the load phase.
+  ///
+  virtual void FinishLoad() { }
+  ///
+  /// Appends engine-internal statistics as name/value pairs.
+  /// Called periodically by the status thread while other threads operate on
+  /// this instance, so only state shared by all instances may be accessed.
+  ///
+  /// @param stats A vector the statistics are appended to.
+  ///
+  virtual void GetStats(std::vector<Field> &stats) { }
+  ///
+  /// Returns the file or directory holding the data of this DB, whose size
+  /// is reported as the size of the database on disk, or an empty string.
+  ///
+  virtual std::string GetDataPath() { return ""; }
+  ///
   /// Reads a record from the database.
   /// Field/value pairs from the result are stored in a vector.
   ///
@@ -54,6 +140,32 @@ class DB {
                    const std::vector<std::string> *fields,
                    std::vector<Field> &result) = 0;
   ///
+  /// Reads a record from the database without copying it.
+  /// The fields are passed to visitor as views that bindings may point into
+  /// memory owned by the engine, so they are only valid during the call.
+  /// The default implementation reads the record with Read().
+  ///
+  /// @param table The name of the table.
+  /// @param key The key of the record to read.
+  /// @param fields The list of fields to read, or NULL for all of them.
+  /// @param visitor Called with the fields of the record if it is found.
+  /// @return Zero on success, or a non-zero error code on error/record-miss.
+  ///
+  virtual Status ReadView(const std::string &table, const std::string &key,
+                          const std::vector<std::string> *fields, const RowVisitor &visitor) {
+    std::vector<Field> result;
+    Status s = Read(table, key, fields, result);
+    if (s == kOK) {
+      std::vector<FieldView> views;
+      views.reserve(result.size());
+      for (const Field &field : result) {
+        views.push_back({field.name, field.value});
+      }
+      visitor(views);
+    }
+    return s;
+  }
+  ///
   /// Performs a range scan for a set of records in the database.
   /// Field/value pairs from the result are stored in a vector.
   ///
@@ -69,6 +181,61 @@ class DB {
                    int record_count, const std::vector<std::string> *fields,
                    std::vector<std::vector<Field>> &result) = 0;
   ///
+  /// Performs a range scan, passing each record to visitor as it is read
+  /// instead of collecting the result first.
+  /// Like in ReadView(), the fields are only valid during the call. The
+  /// default implementation collects the records with Scan().
+  ///
+  /// @param table The name of the table.
+  /// @param key The key of the first record to read.
+  /// @param record_count The maximum number of records to read.
+  /// @param fields The list of fields to read, or NULL for all of them.
+  /// @param visitor Called with the key and fields of each record until it returns false.
+  /// @return Zero on success, or a non-zero error code on error.
+  ///
+  virtual Status ScanView(const std::string &table, const std::string &key, int record_count,
+                          const std::vector<std::string> *fields, const ScanVisitor &visitor) {
+    std::vector<std::vector<Field>> result;
+    Status s = Scan(table, key, record_count, fields, result);
+    if (s != kOK) {
+      return s;
+    }
+    std::vector<FieldView> views;
+    for (const std::vector<Field> &row : result) {
+      views.clear();
+      for (const Field &field : row) {
+        views.push_back({field.name, field.value});
+      }
+      if (!visitor(std::string_view(), views)) {
+        break;
+      }
+    }
+    return kOK;
+  }
+  ///
+  /// Performs a range scan like ScanView() that can stop at an end key and
+  /// run in reverse. Bindings pass the bound to the engine where it can use
+  /// it to skip data. The default implementation only supports unbounded
+  /// forward scans, for which it calls ScanView().
+  ///
+  /// @param table The name of the table.
+  /// @param key The key of the first record to read.
+  /// @param record_count The maximum number of records to read.
+  /// @param bounds The end key and direction of the scan.
+  /// @param fields The list of fields to read, or NULL for all of them.
+  /// @param visitor Called with the key and fields of each record until it returns false.
+  /// @return Zero on success, kNotImplemented if the bounds are not supported,
+  ///         or another non-zero error code on error.
+  ///
+  virtual Status ScanRange(const std::string &table, const std::string &key, int record_count,
+                           const ScanBounds &bounds, const std::vector<std::string> *fields,
+                           const ScanVisitor &visitor) {
+    if (bounds.reverse || !bounds.end_key.empty()) {
+      return kNotImplemented;
+    }
+    return ScanView(table, key, record_count, fields, visitor);
+  }
+  ///
   /// Updates a record in the database.
   /// Field/value pairs in the specified vector are written to the record,
   /// overwriting any existing values with the same field names.
@@ -81,6 +248,29 @@ class DB {
   virtual Status Update(const std::string &table, const std::string &key,
                      std::vector<Field> &values) = 0;
   ///
+  /// Reads a record and then updates it, passing the fields read to visitor
+  /// like ReadView() before the record is written.
+  /// Bindings read the record only once and make both steps atomic where
+  /// the engine allows it. The default implementation calls ReadView() and
+  /// Update().
+  ///
+  /// @param table The name of the table.
+  /// @param key The key of the record to read and write.
+  /// @param fields The list of fields to read, or NULL for all of them.
+  /// @param visitor Called with the fields read if the record is found.
+  /// @param values A vector of field/value pairs to update in the record.
+  /// @return Zero on success, or a non-zero error code on error/record-miss.
+  ///
+  virtual Status ReadModifyWrite(const std::string &table, const std::string &key,
+                                 const std::vector<std::string> *fields,
+                                 const RowVisitor &visitor, std::vector<Field> &values) {
+    Status s = ReadView(table, key, fields, visitor);
+    if (s != kOK) {
+      return s;
+    }
+    return Update(table, key, values);
+  }
+  ///
   /// Inserts a record into the database.
   /// Field/value pairs in the specified vector are written into the record.
   ///
@@ -99,6 +289,59 @@ class DB {
   /// @return Zero on success, a non-zero error code on error.
   ///
   virtual Status Delete(const std::string &table, const std::string &key) = 0;
+  ///
+  /// Starts a transaction.
+  ///
+  /// @param txn The started transaction, owned by the caller.
+  /// @return Zero on success, kAborted if the transaction could not be started
+  ///         due to a conflict, or kNotImplemented if transactions are not supported.
+  ///
+  virtual Status BeginTransaction(Transaction **txn) {
+    return kNotImplemented;
+  }
+  ///
+  /// Reads a set of records and updates another set of records atomically.
+  /// Attempts aborted by a conflict are retried.
+  ///
+  /// @param table The name of the table.
+  /// @param read_keys The keys of the records to read.
+  /// @param fields The list of fields to read, or NULL for all of them.
+  /// @param write_keys The keys of the records to update.
+  /// @param write_values The field/value pairs to update, one vector per write key.
+  /// @param max_retries The number of times an aborted attempt is retried.
+  /// @param hooks Called for each attempt if not NULL.
+  /// @return Zero on commit, or a non-zero error code on error/abort.
+  ///
+  virtual Status ExecuteTransaction(const std::string &table,
+                                    const std::vector<std::string> &read_keys,
+                                    const std::vector<std::string> *fields,
+                                    const std::vector<std::string> &write_keys,
+                                    std::vector<std::vector<Field>> &write_values,
+                                    int max_retries, TransactionHooks *hooks = nullptr) {
+    TransactionHooks no_hooks;
+    if (hooks == nullptr) {
+      hooks = &no_hooks;
+    }
+    Status s = kAborted;
+    for (int attempt = 0; s == kAborted && attempt <= max_retries; attempt++) {
+      hooks->BeginAttempt();
+      Transaction *txn;
+      s = BeginTransaction(&txn);
+      if (s == kOK) {
+        s = TransactionBody(txn, table, read_keys, fields, write_keys, write_values, hooks);
+        if (s == kOK) {
+          hooks->BeginCommit();
+          s = txn->Commit();
+          hooks->EndCommit(s, s != kOK && txn->PartiallyCommitted());
+        } else {
+          txn->Rollback();
+        }
+        delete txn;
+      }
+      hooks->EndAttempt(attempt, s);
+    }
+    return s;
+  }
 
   virtual ~DB() { }
 
@@ -106,6 +349,32 @@ class DB {
     props_ = props;
   }
  protected:
+  ///
+  /// Issues the reads and updates of ExecuteTransaction() in txn.
+  ///
+  static Status TransactionBody(Transaction *txn, const std::string &table,
+                                const std::vector<std::string> &read_keys,
+                                const std::vector<std::string> *fields,
+                                const std::vector<std::string> &write_keys,
+                                std::vector<std::vector<Field>> &write_values,
+                                TransactionHooks *hooks) {
+    for (const std::string &key : read_keys) {
+      std::vector<Field> result;
+      Status s = txn->Read(table, key, fields, result);
+      if (s != kOK) {
+        return s;
+      }
+      hooks->RecordRead(key, result);
+    }
+    for (size_t i = 0; i < write_keys.size(); i++) {
+      Status s = txn->Update(table, write_keys[i], write_values[i]);
+      if (s != kOK) {
+        return s;
+      }
+    }
+    return kOK;
+  }
+
   utils::Properties *props_;
 };
 
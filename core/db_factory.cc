@@ -8,6 +8,7 @@
 
 #include "db_factory.h"
 #include "basic_db.h"
+#include "cache_db.h"
 #include "db_wrapper.h"
 
 namespace ycsbc {
@@ -23,13 +24,25 @@ bool DBFactory::RegisterDB(std::string db_name, DBCreator db_creator) {
   return true;
 }
 
+DB *DBFactory::NewDB(const std::string &db_name) {
+  std::map<std::string, DBCreator> &registry = Registry();
+  auto it = registry.find(db_name);
+  if (it == registry.end()) {
+    return nullptr;
+  }
+  return (*it->second)();
+}
+
 DB *DBFactory::CreateDB(utils::Properties *props, Measurements *measurements) {
   std::string db_name = props->GetProperty("dbname", "basic");
   DB *db = nullptr;
-  std::map<std::string, DBCreator> &registry = Registry();
-  if (registry.find(db_name) != registry.end()) {
-    DB *new_db = (*registry[db_name])();
+  DB *new_db = NewDB(db_name);
+  if (new_db != nullptr) {
     new_db->SetProps(props);
+    if (CacheDB::Enabled(*props)) {
+      new_db = new CacheDB(new_db);
+      new_db->SetProps(props);
+    }
     db = new DBWrapper(new_db, measurements);
   }
   return db;
@@ -23,6 +23,11 @@ class DBFactory {
   using DBCreator = DB *(*)();
   static bool RegisterDB(std::string db_name, DBCreator db_creator);
   static DB *CreateDB(utils::Properties *props, Measurements *measurements);
+  ///
+  /// Creates the binding registered as db_name without any wrapper, or
+  /// returns nullptr if there is none.
+  ///
+  static DB *NewDB(const std::string &db_name);
  private:
   static std::map<std::string, DBCreator> &Registry();
 };
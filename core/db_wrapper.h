@@ -30,67 +30,310 @@ class DBWrapper : public DB {
   void Cleanup() {
     db_->Cleanup();
   }
+  void FinishLoad() {
+    db_->FinishLoad();
+  }
+  void GetStats(std::vector<Field> &stats) {
+    db_->GetStats(stats);
+  }
+  std::string GetDataPath() {
+    return db_->GetDataPath();
+  }
   Status Read(const std::string &table, const std::string &key,
               const std::vector<std::string> *fields, std::vector<Field> &result) {
-    timer_.Start();
+    const bool sampled = measurements_->Sample();
+    if (sampled || Timed()) {
+      timer_.Start();
+    }
     Status s = db_->Read(table, key, fields, result);
-    uint64_t elapsed = timer_.End();
+    uint64_t bytes = s == kOK ? key.size() + RowBytes(result) : 0;
+    Report(s == kOK ? READ : READ_FAILED, sampled, key, fields, nullptr, bytes);
     if (s == kOK) {
-      measurements_->Report(READ, elapsed);
-    } else {
-      measurements_->Report(READ_FAILED, elapsed);
+      measurements_->ReportBytes(BYTES_READ, bytes);
+      measurements_->ReportSize(READ, 1, bytes, 0);
+    }
+    return s;
+  }
+  Status ReadView(const std::string &table, const std::string &key,
+                  const std::vector<std::string> *fields, const RowVisitor &visitor) {
+    const bool sampled = measurements_->Sample();
+    if (sampled || Timed()) {
+      timer_.Start();
+    }
+    // the views are only valid in the visitor
+    uint64_t bytes = key.size();
+    Status s = db_->ReadView(table, key, fields,
+                             [&bytes, &visitor](const std::vector<FieldView> &values) {
+      for (const FieldView &field : values) {
+        bytes += field.name.size() + field.value.size();
+      }
+      visitor(values);
+    });
+    if (s != kOK) {
+      bytes = 0;
+    }
+    Report(s == kOK ? READ : READ_FAILED, sampled, key, fields, nullptr, bytes);
+    if (s == kOK) {
+      measurements_->ReportBytes(BYTES_READ, bytes);
+      measurements_->ReportSize(READ, 1, bytes, 0);
+    }
+    return s;
+  }
+  Status ReadModifyWrite(const std::string &table, const std::string &key,
+                         const std::vector<std::string> *fields, const RowVisitor &visitor,
+                         std::vector<Field> &values) {
+    const bool sampled = measurements_->Sample();
+    if (sampled || Timed()) {
+      timer_.Start();
+    }
+    uint64_t read_bytes = key.size();
+    Status s = db_->ReadModifyWrite(table, key, fields,
+                                    [&read_bytes, &visitor](const std::vector<FieldView> &row) {
+      for (const FieldView &field : row) {
+        read_bytes += field.name.size() + field.value.size();
+      }
+      visitor(row);
+    }, values);
+    uint64_t written_bytes = key.size() + RowBytes(values);
+    Report(s == kOK ? READMODIFYWRITE : READMODIFYWRITE_FAILED, sampled, key, fields, &values,
+           read_bytes + written_bytes);
+    if (s == kOK) {
+      measurements_->ReportBytes(BYTES_READ, read_bytes);
+      measurements_->ReportBytes(BYTES_UPDATED, written_bytes);
+      measurements_->ReportSize(READMODIFYWRITE, 1, read_bytes, written_bytes);
     }
     return s;
   }
   Status Scan(const std::string &table, const std::string &key, int record_count,
               const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result) {
-    timer_.Start();
+    const bool sampled = measurements_->Sample();
+    if (sampled || Timed()) {
+      timer_.Start();
+    }
     Status s = db_->Scan(table, key, record_count, fields, result);
-    uint64_t elapsed = timer_.End();
+    // keys of the scanned records are taken to be as long as the start key
+    uint64_t bytes = s == kOK ? key.size() * result.size() : 0;
     if (s == kOK) {
-      measurements_->Report(SCAN, elapsed);
-    } else {
-      measurements_->Report(SCAN_FAILED, elapsed);
+      for (const std::vector<Field> &row : result) {
+        bytes += RowBytes(row);
+      }
+    }
+    Report(s == kOK ? SCAN : SCAN_FAILED, sampled, key, fields, nullptr, bytes);
+    if (s == kOK) {
+      measurements_->ReportBytes(BYTES_READ, bytes);
+      measurements_->ReportSize(SCAN, result.size(), bytes, 0);
     }
     return s;
   }
+  Status ScanView(const std::string &table, const std::string &key, int record_count,
+                  const std::vector<std::string> *fields, const ScanVisitor &visitor) {
+    return MeasureScan(key, fields, visitor, [&](const ScanVisitor &counted) {
+      return db_->ScanView(table, key, record_count, fields, counted);
+    });
+  }
+  Status ScanRange(const std::string &table, const std::string &key, int record_count,
+                   const ScanBounds &bounds, const std::vector<std::string> *fields,
+                   const ScanVisitor &visitor) {
+    return MeasureScan(key, fields, visitor, [&](const ScanVisitor &counted) {
+      return db_->ScanRange(table, key, record_count, bounds, fields, counted);
+    });
+  }
   Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
-    timer_.Start();
+    const bool sampled = measurements_->Sample();
+    if (sampled || Timed()) {
+      timer_.Start();
+    }
     Status s = db_->Update(table, key, values);
-    uint64_t elapsed = timer_.End();
+    uint64_t bytes = key.size() + RowBytes(values);
+    Report(s == kOK ? UPDATE : UPDATE_FAILED, sampled, key, nullptr, &values, bytes);
     if (s == kOK) {
-      measurements_->Report(UPDATE, elapsed);
-    } else {
-      measurements_->Report(UPDATE_FAILED, elapsed);
+      measurements_->ReportBytes(BYTES_UPDATED, bytes);
+      measurements_->ReportSize(UPDATE, 1, 0, bytes);
     }
     return s;
   }
   Status Insert(const std::string &table, const std::string &key, std::vector<Field> &values) {
-    timer_.Start();
+    const bool sampled = measurements_->Sample();
+    if (sampled || Timed()) {
+      timer_.Start();
+    }
     Status s = db_->Insert(table, key, values);
-    uint64_t elapsed = timer_.End();
+    uint64_t bytes = key.size() + RowBytes(values);
+    // inserts write all fields
+    Report(s == kOK ? INSERT : INSERT_FAILED, sampled, key, nullptr, nullptr, bytes);
     if (s == kOK) {
-      measurements_->Report(INSERT, elapsed);
-    } else {
-      measurements_->Report(INSERT_FAILED, elapsed);
+      measurements_->ReportBytes(BYTES_INSERTED, bytes);
+      measurements_->ReportSize(INSERT, 1, 0, bytes);
     }
     return s;
   }
   Status Delete(const std::string &table, const std::string &key) {
-    timer_.Start();
+    const bool sampled = measurements_->Sample();
+    if (sampled || Timed()) {
+      timer_.Start();
+    }
     Status s = db_->Delete(table, key);
+    Report(s == kOK ? DELETE : DELETE_FAILED, sampled, key, nullptr, nullptr, key.size());
+    if (s == kOK) {
+      measurements_->ReportBytes(BYTES_DELETED, key.size());
+      measurements_->ReportSize(DELETE, 1, 0, key.size());
+    }
+    return s;
+  }
+  Status BeginTransaction(Transaction **txn) {
+    return db_->BeginTransaction(txn);
+  }
+  Status ExecuteTransaction(const std::string &table, const std::vector<std::string> &read_keys,
+                            const std::vector<std::string> *fields,
+                            const std::vector<std::string> &write_keys,
+                            std::vector<std::vector<Field>> &write_values, int max_retries,
+                            TransactionHooks *hooks = nullptr) {
+    MeasuredAttempts attempts(measurements_, hooks);
+    timer_.Start();
+    Status s = db_->ExecuteTransaction(table, read_keys, fields, write_keys, write_values,
+                                       max_retries, &attempts);
     uint64_t elapsed = timer_.End();
+    if (measurements_->breakdown()) {
+      measurements_->ReportStage(STAGE_DB, elapsed);
+    }
     if (s == kOK) {
-      measurements_->Report(DELETE, elapsed);
+      measurements_->Report(TXN, elapsed);
+      // the reads of the attempt that committed
+      measurements_->ReportBytes(BYTES_READ, attempts.bytes_read());
+      uint64_t bytes = 0;
+      for (size_t i = 0; i < write_keys.size(); i++) {
+        bytes += write_keys[i].size() + RowBytes(write_values[i]);
+      }
+      measurements_->ReportBytes(BYTES_UPDATED, bytes);
+      measurements_->ReportSize(TXN, read_keys.size() + write_keys.size(), attempts.bytes_read(),
+                                bytes);
     } else {
-      measurements_->Report(DELETE_FAILED, elapsed);
+      measurements_->Report(TXN_FAILED, elapsed);
     }
     return s;
   }
  private:
+  static uint64_t RowBytes(const std::vector<Field> &values) {
+    uint64_t bytes = 0;
+    for (const Field &field : values) {
+      bytes += field.name.size() + field.value.size();
+    }
+    return bytes;
+  }
+  ///
+  /// Reports the commits, retries and aborts of the attempts of a
+  /// transaction and sums the bytes read by the last attempt, passing the
+  /// callbacks on to the hooks of the caller, if any.
+  ///
+  class MeasuredAttempts : public TransactionHooks {
+   public:
+    MeasuredAttempts(Measurements *measurements, TransactionHooks *next)
+        : measurements_(measurements), next_(next ? next : &no_hooks_) {}
+    void BeginAttempt() {
+      bytes_read_ = 0;
+      attempt_timer_.Start();
+      next_->BeginAttempt();
+    }
+    void RecordRead(const std::string &key, const std::vector<Field> &result) {
+      bytes_read_ += key.size() + RowBytes(result);
+      next_->RecordRead(key, result);
+    }
+    void BeginCommit() {
+      commit_timer_.Start();
+      next_->BeginCommit();
+    }
+    void EndCommit(Status s, bool partial) {
+      if (s == kOK) {
+        measurements_->Report(TXN_COMMIT, commit_timer_.End());
+      } else if (partial) {
+        measurements_->Report(TXN_PARTIAL, commit_timer_.End());
+      }
+      next_->EndCommit(s, partial);
+    }
+    void EndAttempt(int attempt, Status s) {
+      uint64_t attempt_elapsed = attempt_timer_.End();
+      if (attempt > 0) {
+        measurements_->Report(TXN_RETRY, attempt_elapsed);
+      }
+      if (s == kAborted) {
+        measurements_->Report(TXN_ABORT, attempt_elapsed);
+      }
+      next_->EndAttempt(attempt, s);
+    }
+    uint64_t bytes_read() const { return bytes_read_; }
+   private:
+    Measurements *measurements_;
+    TransactionHooks no_hooks_;
+    TransactionHooks *next_;
+    utils::LatencyTimer attempt_timer_;
+    utils::LatencyTimer commit_timer_;
+    uint64_t bytes_read_{0};
+  };
+  ///
+  /// Measures a streaming scan, counting the rows and bytes passed to visitor.
+  ///
+  template <typename F>
+  Status MeasureScan(const std::string &key, const std::vector<std::string> *fields,
+                     const ScanVisitor &visitor, F scan) {
+    const bool sampled = measurements_->Sample();
+    if (sampled || Timed()) {
+      timer_.Start();
+    }
+    uint64_t rows = 0;
+    uint64_t bytes = 0;
+    Status s = scan([&rows, &bytes, &key, &visitor](std::string_view row_key,
+                                                    const std::vector<FieldView> &row) {
+      rows++;
+      // keys not given by the binding are taken to be as long as the start key
+      bytes += row_key.empty() ? key.size() : row_key.size();
+      for (const FieldView &field : row) {
+        bytes += field.name.size() + field.value.size();
+      }
+      return visitor(row_key, row);
+    });
+    if (s != kOK) {
+      bytes = 0;
+    }
+    Report(s == kOK ? SCAN : SCAN_FAILED, sampled, key, fields, nullptr, bytes);
+    if (s == kOK) {
+      measurements_->ReportBytes(BYTES_READ, bytes);
+      measurements_->ReportSize(SCAN, rows, bytes, 0);
+    }
+    return s;
+  }
+  ///
+  /// Whether every operation is timed, not only the sampled ones.
+  ///
+  bool Timed() const {
+    return measurements_->breakdown() || measurements_->trace_slow();
+  }
+  void Report(Operation op, bool sampled, const std::string &key,
+              const std::vector<std::string> *fields, const std::vector<Field> *values,
+              uint64_t bytes) {
+    if (!sampled && !Timed()) {
+      measurements_->ReportCount(op);
+      return;
+    }
+    uint64_t elapsed = timer_.End();
+    if (measurements_->breakdown()) {
+      measurements_->ReportStage(STAGE_DB, elapsed);
+    }
+    if (measurements_->trace_slow()) {
+      measurements_->TraceSlow(op, key, fields, values, bytes, elapsed);
+    }
+    if (sampled) {
+      measurements_->Report(op, elapsed);
+      if (measurements_->key_buckets()) {
+        measurements_->ReportKeyBucket(op, elapsed);
+      }
+    } else {
+      measurements_->ReportCount(op);
+    }
+  }
+
   DB *db_;
   Measurements *measurements_;
-  utils::Timer<uint64_t, std::nano> timer_;
+  utils::LatencyTimer timer_;
 };
 
 } // ycsbc
@@ -10,6 +10,9 @@
 #define YCSB_C_GENERATOR_H_
 
 #include <cstdint>
+#include <mutex>
+
+#include "utils/timer.h"
 
 namespace ycsbc {
 
@@ -21,6 +24,54 @@ class Generator {
   virtual ~Generator() { }
 };
 
+///
+/// Generator of skewed values whose popularity is known, so that operations
+/// can be attributed to popularity buckets.
+///
+class RankedGenerator : public Generator<uint64_t> {
+ public:
+  using Generator<uint64_t>::Next;
+  ///
+  /// Returns the next value and stores its popularity rank as a share of
+  /// the items in rank, 0 for the most popular item.
+  ///
+  virtual uint64_t Next(double *rank) = 0;
+};
+
+///
+/// Lock on the mutex of a generator shared by the client threads. While
+/// timing is enabled, the time each thread waits for such locks is summed
+/// for the overhead breakdown.
+///
+class GeneratorLock {
+ public:
+  explicit GeneratorLock(std::mutex &mutex) : lock_(mutex, std::defer_lock) {
+    if (timed_) {
+      utils::LatencyTimer timer;
+      timer.Start();
+      lock_.lock();
+      wait_ += timer.End();
+    } else {
+      lock_.lock();
+    }
+  }
+
+  static void EnableTiming(bool timed) { timed_ = timed; }
+  ///
+  /// Returns and clears the time the calling thread waited since the last call.
+  ///
+  static uint64_t TakeWait() {
+    uint64_t wait = wait_;
+    wait_ = 0;
+    return wait;
+  }
+
+ private:
+  std::unique_lock<std::mutex> lock_;
+  static inline bool timed_ = false;
+  static inline thread_local uint64_t wait_ = 0;
+};
+
 } // ycsbc
 
 #endif // YCSB_C_GENERATOR_H_
@@ -8,6 +8,8 @@
 #include "measurements.h"
 #include "utils/utils.h"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <numeric>
 #include <sstream>
@@ -19,98 +21,629 @@ namespace {
 #else
   const std::string MEASUREMENT_TYPE_DEFAULT = "basic";
 #endif
+
+  const std::string SAMPLE_INTERVAL = "measurement.sample.interval";
+  const std::string SAMPLE_INTERVAL_DEFAULT = "1";
+
+  const std::string SAMPLE_FRACTION = "measurement.sample.fraction";
+  const std::string SAMPLE_FRACTION_DEFAULT = "1.0";
+
+  const std::string BREAKDOWN = "measurement.breakdown";
+  const std::string BREAKDOWN_DEFAULT = "false";
+
+  const std::string PERF_COUNTERS = "measurement.perf";
+  const std::string PERF_COUNTERS_DEFAULT = "false";
+
+  const std::string PERF_KERNEL = "measurement.perf.kernel";
+  const std::string PERF_KERNEL_DEFAULT = "false";
+
+  const std::string SLOW_TOP_K = "measurement.slowops.topk";
+  const std::string SLOW_TOP_K_DEFAULT = "0";
+
+  const std::string SLOW_THRESHOLD = "measurement.slowops.threshold_us";
+  const std::string SLOW_THRESHOLD_DEFAULT = "0";
+
+  const std::string SLOW_MAX_TRACED = "measurement.slowops.max";
+  const std::string SLOW_MAX_TRACED_DEFAULT = "1000";
+
+  bool SlowerThan(const ycsbc::SlowOperation &a, const ycsbc::SlowOperation &b) {
+    return a.latency > b.latency;
+  }
+
+  const std::string KEY_BUCKETS = "measurement.keybuckets";
+  const std::string KEY_BUCKETS_DEFAULT = "";
+
+  uint64_t BinUpperBound(int bin) {
+    if (bin < 8) {
+      return bin;
+    }
+    int shift = bin / 8 - 1;
+    return ((static_cast<uint64_t>(8 + bin % 8) + 1) << shift) - 1;
+  }
+
+  std::string Percent(double share) {
+    std::ostringstream out;
+    out << share * 100;
+    return out.str();
+  }
+
+  const std::string HDR_FILE_OUTPUT = "hdrhistogram.fileoutput";
+  const std::string HDR_FILE_OUTPUT_DEFAULT = "false";
+
+  const std::string HDR_OUTPUT_PATH = "hdrhistogram.output.path";
+  const std::string HDR_OUTPUT_PATH_DEFAULT = "";
+
+  uint64_t CountOperations(const uint64_t (&count)[ycsbc::MAXOPTYPE]) {
+    uint64_t total_cnt = 0;
+    for (int op = 0; op < ycsbc::TXN_COMMIT; op++) {
+      total_cnt += count[op];
+    }
+    return total_cnt;
+  }
 } // anonymous
 
 namespace ycsbc {
 
-BasicMeasurements::BasicMeasurements() : count_{}, latency_sum_{}, latency_max_{} {
-  std::fill(std::begin(latency_min_), std::end(latency_min_), std::numeric_limits<uint64_t>::max());
+double Measurements::IntervalThroughput(uint64_t total_cnt) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed = now - interval_start_;
+  interval_ops_ = total_cnt - interval_cnt_;
+  double throughput = elapsed.count() > 0 ? interval_ops_ / elapsed.count() : 0;
+  interval_cnt_ = total_cnt;
+  interval_start_ = now;
+  return throughput;
+}
+
+void Measurements::ResetBase() {
+  interval_cnt_ = 0;
+  interval_ops_ = 0;
+  interval_start_ = std::chrono::steady_clock::now();
+  stage_shards_.ForEach([](StageShard &shard) {
+    for (int stage = 0; stage < MAXSTAGE; stage++) {
+      shard.time[stage].store(0, std::memory_order_relaxed);
+    }
+  });
+  byte_shards_.ForEach([](ByteShard &shard) {
+    for (int kind = 0; kind < MAXBYTECOUNT; kind++) {
+      shard.bytes[kind].store(0, std::memory_order_relaxed);
+    }
+  });
+  slow_shards_.ForEach([](SlowShard &shard) {
+    shard.top.clear();
+    shard.above_threshold.clear();
+  });
+  key_bucket_shards_.ForEach([](KeyBucketShard &shard) { shard.buckets.clear(); });
+  size_shards_.ForEach([](SizeShard &shard) {
+    for (int op = 0; op < kSizedOps; op++) {
+      shard.rows[op] = Histogram();
+      shard.bytes_read[op] = Histogram();
+      shard.bytes_written[op] = Histogram();
+    }
+  });
+  std::lock_guard<std::mutex> lock(perf_mutex_);
+  for (PerfCount &count : perf_count_) {
+    count = {0, 0};
+  }
+}
+
+void Measurements::SetKeyBuckets(const std::vector<double> &bounds) {
+  for (size_t i = 0; i < bounds.size(); i++) {
+    if (bounds[i] <= (i ? bounds[i - 1] : 0) || bounds[i] >= 1) {
+      throw utils::Exception("popularity bucket bounds must be increasing and between 0 and 100%");
+    }
+  }
+  key_bucket_bounds_ = bounds;
+}
+
+void Measurements::Histogram::Merge(const Histogram &other) {
+  if (other.count == 0) {
+    return;
+  }
+  min = count ? std::min(min, other.min) : other.min;
+  max = std::max(max, other.max);
+  count += other.count;
+  sum += other.sum;
+  for (int bin = 0; bin < kBins; bin++) {
+    bins[bin] += other.bins[bin];
+  }
+}
+
+DistributionSummary Measurements::Histogram::Summarize() const {
+  DistributionSummary summary{count ? static_cast<double>(sum) / count : 0, min, max, {}};
+  int bin = 0;
+  uint64_t seen = bins[0];
+  for (double p : kSummaryPercentiles) {
+    const uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100 * count));
+    while (seen < rank) {
+      seen += bins[++bin];
+    }
+    summary.percentiles.push_back(std::min(BinUpperBound(bin), max));
+  }
+  return summary;
+}
+
+void Measurements::ReportKeyBucket(Operation op, uint64_t latency) {
+  const int bucket = ThreadKeyBucket();
+  if (bucket < 0 || op >= kRecordOps) {
+    return;
+  }
+  KeyBucketShard &shard = key_bucket_shards_.Local();
+  if (shard.buckets.empty()) {
+    shard.buckets.resize(key_bucket_bounds_.size() + 1);
+  }
+  shard.buckets[bucket].latency[op].Record(latency);
+}
+
+std::vector<KeyBucketSummary> Measurements::GetKeyBuckets() {
+  if (!key_buckets()) {
+    return {};
+  }
+  std::vector<KeyBucketHistogram> merged(key_bucket_bounds_.size() + 1);
+  key_bucket_shards_.ForEach([&merged](KeyBucketShard &shard) {
+    for (size_t b = 0; b < shard.buckets.size(); b++) {
+      for (int op = 0; op < kRecordOps; op++) {
+        merged[b].latency[op].Merge(shard.buckets[b].latency[op]);
+      }
+    }
+  });
+
+  std::vector<KeyBucketSummary> summary;
+  for (size_t b = 0; b < merged.size(); b++) {
+    KeyBucketSummary bucket;
+    bucket.name = Percent(b ? key_bucket_bounds_[b - 1] : 0) + "-" +
+                  Percent(b < key_bucket_bounds_.size() ? key_bucket_bounds_[b] : 1) + "%";
+    for (int i = 0; i < kRecordOps; i++) {
+      Operation op = static_cast<Operation>(i);
+      const Histogram &latency = merged[b].latency[op];
+      if (latency.count == 0) {
+        continue;
+      }
+      DistributionSummary d = latency.Summarize();
+      bucket.measurements.push_back({op, latency.count, latency.count, d.mean, d.min, d.max,
+                                     std::move(d.percentiles)});
+    }
+    summary.push_back(std::move(bucket));
+  }
+  return summary;
+}
+
+std::vector<SizeSummary> Measurements::GetSizes() {
+  // histograms are too large for the stack
+  std::unique_ptr<SizeShard> merged(new SizeShard);
+  size_shards_.ForEach([&merged](SizeShard &shard) {
+    for (int op = 0; op < kSizedOps; op++) {
+      merged->rows[op].Merge(shard.rows[op]);
+      merged->bytes_read[op].Merge(shard.bytes_read[op]);
+      merged->bytes_written[op].Merge(shard.bytes_written[op]);
+    }
+  });
+  std::vector<SizeSummary> sizes;
+  for (int i = 0; i < kSizedOps; i++) {
+    Operation op = static_cast<Operation>(i);
+    if (merged->rows[op].count == 0) {
+      continue;
+    }
+    sizes.push_back({op, merged->rows[op].count, merged->bytes_read[op].sum,
+                     merged->bytes_written[op].sum, merged->rows[op].Summarize(),
+                     merged->bytes_read[op].Summarize(), merged->bytes_written[op].Summarize()});
+  }
+  return sizes;
+}
+
+void Measurements::TraceSlow(Operation op, const std::string &key,
+                             const std::vector<std::string> *fields,
+                             const std::vector<DB::Field> *values, uint64_t bytes,
+                             uint64_t latency) {
+  SlowShard &shard = slow_shards_.Local();
+  std::vector<SlowOperation> *trace;
+  if (slow_threshold_ > 0 && latency >= slow_threshold_ &&
+      shard.above_threshold.size() < slow_max_traced_) {
+    trace = &shard.above_threshold;
+  } else if (shard.top.size() < slow_top_k_ ||
+             (slow_top_k_ > 0 && latency > shard.top.front().latency)) {
+    trace = &shard.top;
+  } else {
+    return;
+  }
+
+  SlowOperation slow{std::chrono::system_clock::now(), op, key, "", bytes, latency};
+  if (fields) {
+    for (const std::string &field : *fields) {
+      slow.fields += (slow.fields.empty() ? "" : ",") + field;
+    }
+  } else if (values) {
+    for (const DB::Field &field : *values) {
+      slow.fields += (slow.fields.empty() ? "" : ",") + field.name;
+    }
+  }
+
+  if (trace == &shard.above_threshold) {
+    shard.above_threshold.push_back(std::move(slow));
+    return;
+  }
+  if (shard.top.size() == slow_top_k_) {
+    std::pop_heap(shard.top.begin(), shard.top.end(), SlowerThan);
+    shard.top.pop_back();
+  }
+  shard.top.push_back(std::move(slow));
+  std::push_heap(shard.top.begin(), shard.top.end(), SlowerThan);
+}
+
+std::vector<SlowOperation> Measurements::GetSlowOperations() {
+  // every operation is in at most one list, so the k slowest overall are
+  // among the merged lists
+  std::vector<SlowOperation> merged;
+  slow_shards_.ForEach([&merged](SlowShard &shard) {
+    merged.insert(merged.end(), shard.top.begin(), shard.top.end());
+    merged.insert(merged.end(), shard.above_threshold.begin(), shard.above_threshold.end());
+  });
+  std::sort(merged.begin(), merged.end(), SlowerThan);
+  std::vector<SlowOperation> result;
+  for (size_t i = 0; i < merged.size(); i++) {
+    if (i < slow_top_k_ || (slow_threshold_ > 0 && merged[i].latency >= slow_threshold_)) {
+      result.push_back(std::move(merged[i]));
+    }
+  }
+  return result;
+}
+
+std::vector<PerfCount> Measurements::GetPerf() {
+  if (!perf_) {
+    return {};
+  }
+  std::lock_guard<std::mutex> lock(perf_mutex_);
+  return std::vector<PerfCount>(perf_count_, perf_count_ + utils::MAXPERFCOUNTER);
+}
+
+std::vector<uint64_t> Measurements::GetBytes() {
+  std::vector<uint64_t> bytes(MAXBYTECOUNT);
+  byte_shards_.ForEach([&bytes](ByteShard &shard) {
+    for (int kind = 0; kind < MAXBYTECOUNT; kind++) {
+      bytes[kind] += shard.bytes[kind].load(std::memory_order_relaxed);
+    }
+  });
+  return bytes;
+}
+
+std::vector<uint64_t> Measurements::GetBreakdown() {
+  if (!breakdown_) {
+    return {};
+  }
+  std::vector<uint64_t> time(MAXSTAGE);
+  stage_shards_.ForEach([&time](StageShard &shard) {
+    for (int stage = 0; stage < MAXSTAGE; stage++) {
+      time[stage] += shard.time[stage].load(std::memory_order_relaxed);
+    }
+  });
+  return time;
+}
+
+BasicMeasurements::BasicMeasurements() {
+}
+
+BasicMeasurements::Shard::Shard() {
+  Reset();
+}
+
+void BasicMeasurements::Shard::Reset() {
+  for (int op = 0; op < MAXOPTYPE; op++) {
+    count[op].store(0, std::memory_order_relaxed);
+    samples[op].store(0, std::memory_order_relaxed);
+    latency_sum[op].store(0, std::memory_order_relaxed);
+    latency_min[op].store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    latency_max[op].store(0, std::memory_order_relaxed);
+  }
 }
 
 void BasicMeasurements::Report(Operation op, uint64_t latency) {
-  count_[op].fetch_add(1, std::memory_order_relaxed);
-  latency_sum_[op].fetch_add(latency, std::memory_order_relaxed);
-  uint64_t prev_min = latency_min_[op].load(std::memory_order_relaxed);
-  while (prev_min > latency
-         && !latency_min_[op].compare_exchange_weak(prev_min, latency, std::memory_order_relaxed));
-  uint64_t prev_max = latency_max_[op].load(std::memory_order_relaxed);
-  while (prev_max < latency
-         && !latency_max_[op].compare_exchange_weak(prev_max, latency, std::memory_order_relaxed));
+  // single writer per shard, so plain loads and stores suffice
+  Shard &shard = shards_.Local();
+  shard.count[op].store(shard.count[op].load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
+  shard.samples[op].store(shard.samples[op].load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+  shard.latency_sum[op].store(shard.latency_sum[op].load(std::memory_order_relaxed) + latency,
+                              std::memory_order_relaxed);
+  if (latency < shard.latency_min[op].load(std::memory_order_relaxed)) {
+    shard.latency_min[op].store(latency, std::memory_order_relaxed);
+  }
+  if (latency > shard.latency_max[op].load(std::memory_order_relaxed)) {
+    shard.latency_max[op].store(latency, std::memory_order_relaxed);
+  }
+}
+
+void BasicMeasurements::Merge(Shard &merged) {
+  uint64_t count[MAXOPTYPE] = {};
+  uint64_t samples[MAXOPTYPE] = {};
+  uint64_t latency_sum[MAXOPTYPE] = {};
+  uint64_t latency_min[MAXOPTYPE];
+  uint64_t latency_max[MAXOPTYPE] = {};
+  std::fill(std::begin(latency_min), std::end(latency_min), std::numeric_limits<uint64_t>::max());
+  shards_.ForEach([&](Shard &shard) {
+    for (int op = 0; op < MAXOPTYPE; op++) {
+      count[op] += shard.count[op].load(std::memory_order_relaxed);
+      samples[op] += shard.samples[op].load(std::memory_order_relaxed);
+      latency_sum[op] += shard.latency_sum[op].load(std::memory_order_relaxed);
+      latency_min[op] = std::min(latency_min[op], shard.latency_min[op].load(std::memory_order_relaxed));
+      latency_max[op] = std::max(latency_max[op], shard.latency_max[op].load(std::memory_order_relaxed));
+    }
+  });
+  for (int op = 0; op < MAXOPTYPE; op++) {
+    merged.count[op].store(count[op], std::memory_order_relaxed);
+    merged.samples[op].store(samples[op], std::memory_order_relaxed);
+    merged.latency_sum[op].store(latency_sum[op], std::memory_order_relaxed);
+    merged.latency_min[op].store(latency_min[op], std::memory_order_relaxed);
+    merged.latency_max[op].store(latency_max[op], std::memory_order_relaxed);
+  }
+}
+
+void BasicMeasurements::ReportCount(Operation op) {
+  Shard &shard = shards_.Local();
+  shard.count[op].store(shard.count[op].load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
 }
 
 std::string BasicMeasurements::GetStatusMsg() {
+  Shard merged;
+  Merge(merged);
+  uint64_t count[MAXOPTYPE];
+  uint64_t samples[MAXOPTYPE];
+  uint64_t latency_sum[MAXOPTYPE];
+  uint64_t latency_min[MAXOPTYPE];
+  uint64_t latency_max[MAXOPTYPE];
+  for (int op = 0; op < MAXOPTYPE; op++) {
+    count[op] = merged.count[op].load(std::memory_order_relaxed);
+    samples[op] = merged.samples[op].load(std::memory_order_relaxed);
+    latency_sum[op] = merged.latency_sum[op].load(std::memory_order_relaxed);
+    latency_min[op] = merged.latency_min[op].load(std::memory_order_relaxed);
+    latency_max[op] = merged.latency_max[op].load(std::memory_order_relaxed);
+  }
+
+  uint64_t total_cnt = CountOperations(count);
   std::ostringstream msg_stream;
   msg_stream.precision(2);
-  uint64_t total_cnt = 0;
-  msg_stream << std::fixed << " operations;";
+  msg_stream << std::fixed << " operations; " << IntervalThroughput(total_cnt) << " current ops/sec;";
   for (int i = 0; i < MAXOPTYPE; i++) {
     Operation op = static_cast<Operation>(i);
-    uint64_t cnt = count_[op].load(std::memory_order_relaxed);
+    uint64_t cnt = count[op];
     if (cnt == 0)
       continue;
     msg_stream << " [" << kOperationString[op] << ":"
-               << " Count=" << cnt
-               << " Max=" << latency_max_[op].load(std::memory_order_relaxed) / 1000.0
-               << " Min=" << latency_min_[op].load(std::memory_order_relaxed) / 1000.0
-               << " Avg="
-               << ((cnt > 0)
-                   ? static_cast<double>(latency_sum_[op].load(std::memory_order_relaxed)) / cnt
-                   : 0) / 1000.0
-               << "]";
-    total_cnt += cnt;
+               << " Count=" << cnt;
+    if (samples[op] > 0) {
+      msg_stream << " Max=" << latency_max[op] / 1000.0
+                 << " Min=" << latency_min[op] / 1000.0
+                 << " Avg=" << static_cast<double>(latency_sum[op]) / samples[op] / 1000.0;
+    }
+    msg_stream << "]";
   }
   return std::to_string(total_cnt) + msg_stream.str();
 }
 
+std::vector<OperationSummary> BasicMeasurements::GetSummary() {
+  Shard merged;
+  Merge(merged);
+  std::vector<OperationSummary> summary;
+  for (int i = 0; i < MAXOPTYPE; i++) {
+    Operation op = static_cast<Operation>(i);
+    uint64_t cnt = merged.count[op].load(std::memory_order_relaxed);
+    uint64_t samples = merged.samples[op].load(std::memory_order_relaxed);
+    if (cnt == 0)
+      continue;
+    if (samples == 0) {
+      summary.push_back({op, cnt, 0, 0, 0, 0, {}});
+      continue;
+    }
+    summary.push_back({op, cnt, samples,
+                       static_cast<double>(merged.latency_sum[op].load(std::memory_order_relaxed)) / samples,
+                       merged.latency_min[op].load(std::memory_order_relaxed),
+                       merged.latency_max[op].load(std::memory_order_relaxed), {}});
+  }
+  return summary;
+}
+
 void BasicMeasurements::Reset() {
-  std::fill(std::begin(count_), std::end(count_), 0);
-  std::fill(std::begin(latency_sum_), std::end(latency_sum_), 0);
-  std::fill(std::begin(latency_min_), std::end(latency_min_), std::numeric_limits<uint64_t>::max());
-  std::fill(std::begin(latency_max_), std::end(latency_max_), 0);
+  shards_.ForEach([](Shard &shard) { shard.Reset(); });
+  ResetBase();
 }
 
 #ifdef HDRMEASUREMENT
-HdrHistogramMeasurements::HdrHistogramMeasurements() {
+namespace {
+  hdr_histogram *NewHistogram() {
+    hdr_histogram *histogram;
+    if (hdr_init(10, 100LL * 1000 * 1000 * 1000, 3, &histogram) != 0) {
+      throw utils::Exception("hdr init failed");
+    }
+    return histogram;
+  }
+} // anonymous
+
+void SubtractHistogram(hdr_histogram *result, const hdr_histogram *a, const hdr_histogram *b) {
+  hdr_reset(result);
+  // every bucket of a is compared, b may have no values in the ones above its maximum
+  hdr_iter iter;
+  hdr_iter_recorded_init(&iter, a);
+  while (hdr_iter_next(&iter)) {
+    int64_t count = iter.count - hdr_count_at_value(b, iter.value);
+    if (count > 0) {
+      hdr_record_values(result, iter.value, count);
+    }
+  }
+}
+
+HdrHistogramMeasurements::Shard::Shard() {
+  for (int op = 0; op < MAXOPTYPE; op++) {
+    count[op].store(0, std::memory_order_relaxed);
+    histogram[op] = NewHistogram();
+  }
+}
+
+void HdrHistogramMeasurements::Shard::Reset() {
   for (int op = 0; op < MAXOPTYPE; op++) {
-    if (hdr_init(10, 100LL * 1000 * 1000 * 1000, 3, &histogram_[op]) != 0) {
-      utils::Exception("hdr init failed");
+    count[op].store(0, std::memory_order_relaxed);
+    hdr_reset(histogram[op]);
+  }
+}
+
+HdrHistogramMeasurements::Shard::~Shard() {
+  for (int op = 0; op < MAXOPTYPE; op++) {
+    hdr_close(histogram[op]);
+  }
+}
+
+HdrHistogramMeasurements::HdrHistogramMeasurements(utils::Properties *props) : log_file_{},
+    last_{}, interval_{} {
+  for (int op = 0; op < MAXOPTYPE; op++) {
+    merged_[op] = NewHistogram();
+  }
+  log_intervals_ = utils::StrToBool(props->GetProperty(HDR_FILE_OUTPUT, HDR_FILE_OUTPUT_DEFAULT));
+  if (log_intervals_) {
+    log_prefix_ = props->GetProperty(HDR_OUTPUT_PATH, HDR_OUTPUT_PATH_DEFAULT);
+    if (hdr_log_writer_init(&log_writer_) != 0) {
+      throw utils::Exception("hdr log writer init failed");
+    }
+    for (int op = 0; op < MAXOPTYPE; op++) {
+      last_[op] = NewHistogram();
+      interval_[op] = NewHistogram();
+    }
+    hdr_gettime(&log_start_);
+    interval_start_ = log_start_;
+  }
+}
+
+HdrHistogramMeasurements::~HdrHistogramMeasurements() {
+  for (int op = 0; op < MAXOPTYPE; op++) {
+    hdr_close(merged_[op]);
+    if (log_intervals_) {
+      hdr_close(last_[op]);
+      hdr_close(interval_[op]);
+    }
+    if (log_file_[op]) {
+      fclose(log_file_[op]);
     }
   }
 }
 
 void HdrHistogramMeasurements::Report(Operation op, uint64_t latency) {
-  hdr_record_value_atomic(histogram_[op], latency);
+  Shard &shard = shards_.Local();
+  shard.count[op].store(shard.count[op].load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
+  // the shard is only contended by a concurrent GetStatusMsg()
+  hdr_record_value_atomic(shard.histogram[op], latency);
+}
+
+void HdrHistogramMeasurements::ReportCount(Operation op) {
+  Shard &shard = shards_.Local();
+  shard.count[op].store(shard.count[op].load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
+}
+
+void HdrHistogramMeasurements::MergeShards() {
+  for (int op = 0; op < MAXOPTYPE; op++) {
+    hdr_reset(merged_[op]);
+    merged_count_[op] = 0;
+  }
+  shards_.ForEach([this](Shard &shard) {
+    for (int op = 0; op < MAXOPTYPE; op++) {
+      merged_count_[op] += shard.count[op].load(std::memory_order_relaxed);
+      hdr_add(merged_[op], shard.histogram[op]);
+    }
+  });
 }
 
 std::string HdrHistogramMeasurements::GetStatusMsg() {
+  std::lock_guard<std::mutex> lock(merged_mutex_);
+  MergeShards();
+  if (log_intervals_) {
+    LogInterval();
+  }
+
+  uint64_t total_cnt = CountOperations(merged_count_);
   std::ostringstream msg_stream;
   msg_stream.precision(2);
-  uint64_t total_cnt = 0;
-  msg_stream << std::fixed << " operations;";
+  msg_stream << std::fixed << " operations; " << IntervalThroughput(total_cnt) << " current ops/sec;";
   for (int i = 0; i < MAXOPTYPE; i++) {
     Operation op = static_cast<Operation>(i);
-    uint64_t cnt = histogram_[op]->total_count;
+    uint64_t cnt = merged_count_[op];
     if (cnt == 0)
       continue;
     msg_stream << " [" << kOperationString[op] << ":"
-               << " Count=" << cnt
-               << " Max=" << hdr_max(histogram_[op]) / 1000.0
-               << " Min=" << hdr_min(histogram_[op]) / 1000.0
-               << " Avg=" << hdr_mean(histogram_[op]) / 1000.0
-               << " 90=" << hdr_value_at_percentile(histogram_[op], 90) / 1000.0
-               << " 99=" << hdr_value_at_percentile(histogram_[op], 99) / 1000.0
-               << " 99.9=" << hdr_value_at_percentile(histogram_[op], 99.9) / 1000.0
-               << " 99.99=" << hdr_value_at_percentile(histogram_[op], 99.99) / 1000.0
-               << "]";
-    total_cnt += cnt;
+               << " Count=" << cnt;
+    if (merged_[op]->total_count > 0) {
+      msg_stream << " Max=" << hdr_max(merged_[op]) / 1000.0
+                 << " Min=" << hdr_min(merged_[op]) / 1000.0
+                 << " Avg=" << hdr_mean(merged_[op]) / 1000.0
+                 << " 90=" << hdr_value_at_percentile(merged_[op], 90) / 1000.0
+                 << " 99=" << hdr_value_at_percentile(merged_[op], 99) / 1000.0
+                 << " 99.9=" << hdr_value_at_percentile(merged_[op], 99.9) / 1000.0
+                 << " 99.99=" << hdr_value_at_percentile(merged_[op], 99.99) / 1000.0;
+    }
+    msg_stream << "]";
   }
   return std::to_string(total_cnt) + msg_stream.str();
 }
 
+std::vector<OperationSummary> HdrHistogramMeasurements::GetSummary() {
+  std::lock_guard<std::mutex> lock(merged_mutex_);
+  MergeShards();
+  std::vector<OperationSummary> summary;
+  for (int i = 0; i < MAXOPTYPE; i++) {
+    Operation op = static_cast<Operation>(i);
+    uint64_t cnt = merged_count_[op];
+    uint64_t samples = merged_[op]->total_count;
+    if (cnt == 0)
+      continue;
+    if (samples == 0) {
+      summary.push_back({op, cnt, 0, 0, 0, 0, {}});
+      continue;
+    }
+    std::vector<uint64_t> percentiles;
+    for (double p : kSummaryPercentiles) {
+      percentiles.push_back(hdr_value_at_percentile(merged_[op], p));
+    }
+    summary.push_back({op, cnt, samples, hdr_mean(merged_[op]), static_cast<uint64_t>(hdr_min(merged_[op])),
+                       static_cast<uint64_t>(hdr_max(merged_[op])), std::move(percentiles)});
+  }
+  return summary;
+}
+
+void HdrHistogramMeasurements::LogInterval() {
+  hdr_timespec now;
+  hdr_gettime(&now);
+  for (int i = 0; i < MAXOPTYPE; i++) {
+    Operation op = static_cast<Operation>(i);
+    SubtractHistogram(interval_[op], merged_[op], last_[op]);
+    hdr_reset(last_[op]);
+    hdr_add(last_[op], merged_[op]);
+    if (log_file_[op] == nullptr) {
+      if (interval_[op]->total_count == 0) {
+        continue;
+      }
+      std::string file_name = log_prefix_ + kOperationString[op] + ".hlog";
+      log_file_[op] = fopen(file_name.c_str(), "w");
+      if (log_file_[op] == nullptr) {
+        throw utils::Exception("failed to open: " + file_name);
+      }
+      hdr_log_write_header(&log_writer_, log_file_[op], "YCSB-cpp latency in nanoseconds", &log_start_);
+    }
+    // the interval count over the interval length is the throughput of the operation
+    hdr_log_write(&log_writer_, log_file_[op], &interval_start_, &now, interval_[op]);
+    fflush(log_file_[op]);
+  }
+  interval_start_ = now;
+}
+
 void HdrHistogramMeasurements::Reset() {
-  for (int op = 0; op < MAXOPTYPE; op++) {
-    hdr_reset(histogram_[op]);
+  // a concurrent MergeShards() must not add a shard while it is reset
+  std::lock_guard<std::mutex> lock(merged_mutex_);
+  shards_.ForEach([](Shard &shard) { shard.Reset(); });
+  if (log_intervals_) {
+    for (int op = 0; op < MAXOPTYPE; op++) {
+      hdr_reset(last_[op]);
+    }
+    hdr_gettime(&interval_start_);
   }
+  ResetBase();
 }
 #endif
 
@@ -122,11 +655,27 @@ Measurements *CreateMeasurements(utils::Properties *props) {
     measurements = new BasicMeasurements();
 #ifdef HDRMEASUREMENT
   } else if (name == "hdrhistogram") {
-    measurements = new HdrHistogramMeasurements();
+    measurements = new HdrHistogramMeasurements(props);
 #endif
   } else {
-    measurements = nullptr;
+    return nullptr;
+  }
+  measurements->SetSampling(std::stoull(props->GetProperty(SAMPLE_INTERVAL, SAMPLE_INTERVAL_DEFAULT)),
+                            std::stod(props->GetProperty(SAMPLE_FRACTION, SAMPLE_FRACTION_DEFAULT)));
+  measurements->SetBreakdown(utils::StrToBool(props->GetProperty(BREAKDOWN, BREAKDOWN_DEFAULT)));
+  measurements->SetPerfCounters(
+      utils::StrToBool(props->GetProperty(PERF_COUNTERS, PERF_COUNTERS_DEFAULT)),
+      utils::StrToBool(props->GetProperty(PERF_KERNEL, PERF_KERNEL_DEFAULT)));
+  measurements->SetSlowOperations(
+      std::stoul(props->GetProperty(SLOW_TOP_K, SLOW_TOP_K_DEFAULT)),
+      std::stoull(props->GetProperty(SLOW_THRESHOLD, SLOW_THRESHOLD_DEFAULT)) * 1000,
+      std::stoul(props->GetProperty(SLOW_MAX_TRACED, SLOW_MAX_TRACED_DEFAULT)));
+  std::vector<double> key_bucket_bounds;
+  std::istringstream bounds(props->GetProperty(KEY_BUCKETS, KEY_BUCKETS_DEFAULT));
+  for (std::string bound; std::getline(bounds, bound, ',');) {
+    key_bucket_bounds.push_back(std::stod(utils::Trim(bound)) / 100);
   }
+  measurements->SetKeyBuckets(key_bucket_bounds);
 
   return measurements;
 }
@@ -9,48 +9,522 @@
 #define YCSB_C_MEASUREMENTS_H_
 
 #include "core_workload.h"
+#include "db.h"
+#include "utils/perf_counters.h"
 #include "utils/properties.h"
+#include "utils/utils.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #ifdef HDRMEASUREMENT
 #include <hdr/hdr_histogram.h>
+#include <hdr/hdr_histogram_log.h>
 #endif
 
 typedef unsigned int uint;
 
 namespace ycsbc {
 
+///
+/// Per-thread instances of T, created on the first access of each thread, so
+/// that threads record without sharing cache lines. A thread is expected to
+/// access a single ThreadShards<T> instance. The shard of a thread that exits
+/// is kept with what it recorded and handed to the next thread that needs one,
+/// so that the load and run threads share the same shards.
+///
+template <typename T>
+class ThreadShards {
+ public:
+  ThreadShards() : id_(next_id_.fetch_add(1) + 1), pool_(std::make_shared<Pool>()) {}
+
+  T &Local() {
+    thread_local Cached cached;
+    if (cached.id != id_) {
+      cached.Release();
+      std::lock_guard<std::mutex> lock(pool_->mutex);
+      if (pool_->free.empty()) {
+        pool_->shards.emplace_back(new T());
+        cached.shard = pool_->shards.back().get();
+      } else {
+        cached.shard = pool_->free.back();
+        pool_->free.pop_back();
+      }
+      cached.id = id_;
+      cached.pool = pool_;
+    }
+    return *cached.shard;
+  }
+
+  template <typename F>
+  void ForEach(F f) {
+    std::lock_guard<std::mutex> lock(pool_->mutex);
+    for (auto &shard : pool_->shards) {
+      f(*shard);
+    }
+  }
+
+ private:
+  // all shards and the ones without a thread, outlives the instance while
+  // a thread still holds one of its shards
+  struct Pool {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<T>> shards;
+    std::vector<T *> free;
+  };
+  struct Cached {
+    uint64_t id = 0;
+    T *shard = nullptr;
+    std::weak_ptr<Pool> pool;
+
+    ~Cached() { Release(); }
+    void Release() {
+      if (std::shared_ptr<Pool> p = pool.lock()) {
+        std::lock_guard<std::mutex> lock(p->mutex);
+        p->free.push_back(shard);
+      }
+      pool.reset();
+    }
+  };
+
+  static inline std::atomic<uint64_t> next_id_{0};
+  const uint64_t id_;
+  std::shared_ptr<Pool> pool_;
+};
+
+///
+/// Stages of the client loop timed by the overhead breakdown.
+///
+enum Stage {
+  STAGE_THROTTLE = 0,   // waiting in the rate limiter
+  STAGE_OPERATION,      // whole DoInsert/DoTransaction call
+  STAGE_DB,             // inside the DB binding
+  STAGE_KEY_ACK,        // acknowledging inserted keys, without the lock wait
+  STAGE_KEY_CHOICE,     // drawing key numbers from the generators, without the lock wait
+  STAGE_BUILD_KEY,      // BuildKeyName()
+  STAGE_BUILD_VALUES,   // BuildValues() and BuildSingleValue()
+  STAGE_GENERATOR_LOCK, // waiting for the mutexes of shared generators
+  MAXSTAGE
+};
+
+///
+/// Logical bytes moved by successful operations, counting keys and field
+/// names and values.
+///
+enum ByteCount {
+  BYTES_INSERTED = 0,
+  BYTES_UPDATED,
+  BYTES_DELETED,
+  BYTES_READ,
+  MAXBYTECOUNT
+};
+
+///
+/// Total of a performance counter over the operations of the threads that
+/// could open it.
+///
+struct PerfCount {
+  uint64_t value;
+  uint64_t ops;
+};
+
+///
+/// An operation recorded by the slow operation trace.
+///
+struct SlowOperation {
+  std::chrono::system_clock::time_point time;
+  Operation op;
+  std::string key;
+  // selected or written fields separated by ',', empty for all fields
+  std::string fields;
+  uint64_t bytes;
+  uint64_t latency;
+};
+
+///
+/// Percentiles included in an OperationSummary.
+///
+const double kSummaryPercentiles[] = {50, 90, 95, 99, 99.9, 99.99};
+
+///
+/// Measurements of one operation type, latencies in nanoseconds.
+///
+struct OperationSummary {
+  Operation op;
+  uint64_t count;
+  // number of operations whose latency was recorded
+  uint64_t samples;
+  double mean;
+  uint64_t min;
+  uint64_t max;
+  // latency at each of kSummaryPercentiles, empty if not tracked
+  std::vector<uint64_t> percentiles;
+};
+
+///
+/// Operations on records addressed by a key, the ones attributed to
+/// popularity buckets, are the ones before TXN.
+///
+const int kRecordOps = TXN;
+///
+/// Operations sized by their rows and bytes are the record operations and
+/// TXN.
+///
+const int kSizedOps = TXN + 1;
+
+///
+/// Distribution of a value, with the value at each of kSummaryPercentiles.
+///
+struct DistributionSummary {
+  double mean;
+  uint64_t min;
+  uint64_t max;
+  std::vector<uint64_t> percentiles;
+};
+
+///
+/// Sizes of the successful operations of one type.
+///
+struct SizeSummary {
+  Operation op;
+  uint64_t count;
+  // keys, field names and values read and written
+  uint64_t bytes_read;
+  uint64_t bytes_written;
+  // records read or written, counted once for a READMODIFYWRITE
+  DistributionSummary rows_per_op;
+  DistributionSummary bytes_read_per_op;
+  DistributionSummary bytes_written_per_op;
+};
+
+
+///
+/// Measurements of the operations on keys of one popularity bucket.
+///
+struct KeyBucketSummary {
+  // range of popularity ranks as percentages of the key space, e.g. "1-10%"
+  std::string name;
+  std::vector<OperationSummary> measurements;
+};
+
 class Measurements {
  public:
+  virtual ~Measurements() { }
   virtual void Report(Operation op, uint64_t latency) = 0;
+  ///
+  /// Counts an operation whose latency was not sampled.
+  ///
+  virtual void ReportCount(Operation op) = 0;
   virtual std::string GetStatusMsg() = 0;
+  ///
+  /// Returns the measurements of every operation type with a non-zero count.
+  ///
+  virtual std::vector<OperationSummary> GetSummary() = 0;
   virtual void Reset() = 0;
+
+  ///
+  /// Records the latency of only every interval-th operation of a thread if
+  /// interval > 1, or else of each operation with probability fraction.
+  ///
+  void SetSampling(uint64_t interval, double fraction) {
+    sample_interval_ = interval;
+    sample_fraction_ = fraction;
+  }
+
+  ///
+  /// Whether the latency of the calling thread's next operation is recorded.
+  ///
+  bool Sample() {
+    if (sample_interval_ > 1) {
+      thread_local uint64_t ops = 0;
+      return ++ops % sample_interval_ == 0;
+    }
+    return sample_fraction_ >= 1.0 || utils::ThreadLocalRandomDouble() < sample_fraction_;
+  }
+
+  void SetBreakdown(bool breakdown) { breakdown_ = breakdown; }
+  ///
+  /// Whether the client loop reports its stage times with ReportStage().
+  ///
+  bool breakdown() const { return breakdown_; }
+  void ReportStage(Stage stage, uint64_t latency) {
+    StageShard &shard = stage_shards_.Local();
+    shard.time[stage].store(shard.time[stage].load(std::memory_order_relaxed) + latency,
+                            std::memory_order_relaxed);
+  }
+  ///
+  /// Returns the time in nanoseconds spent in each stage summed over all
+  /// threads, or an empty vector if the breakdown is disabled.
+  ///
+  std::vector<uint64_t> GetBreakdown();
+  void ReportBytes(ByteCount kind, uint64_t bytes) {
+    ByteShard &shard = byte_shards_.Local();
+    shard.bytes[kind].store(shard.bytes[kind].load(std::memory_order_relaxed) + bytes,
+                            std::memory_order_relaxed);
+  }
+  ///
+  /// Returns the logical bytes of each ByteCount summed over all threads.
+  ///
+  std::vector<uint64_t> GetBytes();
+  void SetPerfCounters(bool perf, bool kernel) {
+    perf_ = perf;
+    perf_kernel_ = kernel;
+  }
+  ///
+  /// Whether client threads count their operations with performance counters.
+  ///
+  bool perf_counters() const { return perf_; }
+  ///
+  /// Whether the hardware performance counters include kernel mode.
+  ///
+  bool perf_kernel() const { return perf_kernel_; }
+  void ReportPerf(utils::PerfCounter counter, uint64_t value, uint64_t ops) {
+    std::lock_guard<std::mutex> lock(perf_mutex_);
+    perf_count_[counter].value += value;
+    perf_count_[counter].ops += ops;
+  }
+  ///
+  /// Returns the total of each utils::PerfCounter, or an empty vector if
+  /// performance counters are disabled.
+  ///
+  std::vector<PerfCount> GetPerf();
+  ///
+  /// Traces the top_k slowest operations of each thread, and up to
+  /// max_traced operations of each thread that took at least threshold
+  /// nanoseconds.
+  ///
+  void SetSlowOperations(size_t top_k, uint64_t threshold, size_t max_traced) {
+    slow_top_k_ = top_k;
+    slow_threshold_ = threshold;
+    slow_max_traced_ = max_traced;
+  }
+  ///
+  /// Whether DB operations are passed to TraceSlow().
+  ///
+  bool trace_slow() const { return slow_top_k_ > 0 || slow_threshold_ > 0; }
+  void TraceSlow(Operation op, const std::string &key, const std::vector<std::string> *fields,
+                 const std::vector<DB::Field> *values, uint64_t bytes, uint64_t latency);
+  ///
+  /// Returns the top-k slowest operations over all threads and the
+  /// operations above the threshold, slowest first.
+  ///
+  std::vector<SlowOperation> GetSlowOperations();
+  ///
+  /// Splits the sampled latencies of operations on keys of known popularity
+  /// into buckets. bounds holds the upper rank of each bucket but the last
+  /// as a share of the key space, in increasing order.
+  ///
+  void SetKeyBuckets(const std::vector<double> &bounds);
+  ///
+  /// Whether the workload reports the popularity of its keys with SetKeyRank().
+  ///
+  bool key_buckets() const { return !key_bucket_bounds_.empty(); }
+  ///
+  /// Attributes the calling thread's next operations to the popularity bucket
+  /// of rank, a share of the key space with 0 for the most popular key.
+  ///
+  void SetKeyRank(double rank) {
+    size_t bucket = 0;
+    while (bucket < key_bucket_bounds_.size() && rank >= key_bucket_bounds_[bucket]) {
+      bucket++;
+    }
+    ThreadKeyBucket() = static_cast<int>(bucket);
+  }
+  ///
+  /// Stops attributing the calling thread's operations to a bucket.
+  ///
+  void ClearKeyRank() { ThreadKeyBucket() = -1; }
+  void ReportKeyBucket(Operation op, uint64_t latency);
+  ///
+  /// Returns the measurements of each popularity bucket, most popular first,
+  /// or an empty vector if the keys are not bucketed.
+  ///
+  std::vector<KeyBucketSummary> GetKeyBuckets();
+  ///
+  /// Records the rows and the bytes read and written of a successful
+  /// operation.
+  ///
+  void ReportSize(Operation op, uint64_t rows, uint64_t bytes_read, uint64_t bytes_written) {
+    if (op < kSizedOps) {
+      SizeShard &shard = size_shards_.Local();
+      shard.rows[op].Record(rows);
+      shard.bytes_read[op].Record(bytes_read);
+      shard.bytes_written[op].Record(bytes_written);
+    }
+  }
+  ///
+  /// Returns the sizes of every operation type with a successful operation.
+  ///
+  std::vector<SizeSummary> GetSizes();
+  ///
+  /// Number of operations in the interval of the last GetStatusMsg().
+  ///
+  uint64_t interval_operations() const { return interval_ops_; }
+ protected:
+  ///
+  /// Returns the throughput in ops/sec since the previous call or ResetBase().
+  ///
+  double IntervalThroughput(uint64_t total_cnt);
+  ///
+  /// Resets the interval throughput, the overhead breakdown, the byte counts,
+  /// the performance counters, the slow operation trace, the popularity
+  /// buckets and the operation sizes.
+  ///
+  void ResetBase();
+ private:
+  struct StageShard {
+    std::atomic<uint64_t> time[MAXSTAGE] = {};
+  };
+  struct ByteShard {
+    std::atomic<uint64_t> bytes[MAXBYTECOUNT] = {};
+  };
+  // only accessed by the owning thread while the client threads run
+  struct SlowShard {
+    // min-heap by latency of the slowest operations below the threshold
+    std::vector<SlowOperation> top;
+    std::vector<SlowOperation> above_threshold;
+  };
+  // values in log-linear bins of 1/8 of a power of two
+  struct Histogram {
+    static constexpr int kBins = 496;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t min = 0;
+    uint64_t max = 0;
+    uint64_t bins[kBins] = {};
+    // bins 0-7 hold the values 0-7 exactly, then each power of two is split
+    // into 8 bins of equal width
+    static int Bin(uint64_t value) {
+      if (value < 8) {
+        return static_cast<int>(value);
+      }
+      int msb = 63 - __builtin_clzll(value);
+      return (msb - 2) * 8 + static_cast<int>((value >> (msb - 3)) & 7);
+    }
+    void Record(uint64_t value) {
+      if (count == 0 || value < min) {
+        min = value;
+      }
+      max = std::max(max, value);
+      count++;
+      sum += value;
+      bins[Bin(value)]++;
+    }
+    void Merge(const Histogram &other);
+    DistributionSummary Summarize() const;
+  };
+  // only accessed by the owning thread while the client threads run
+  struct KeyBucketHistogram {
+    Histogram latency[kRecordOps];
+  };
+  struct KeyBucketShard {
+    std::vector<KeyBucketHistogram> buckets;
+  };
+  // only accessed by the owning thread while the client threads run
+  struct SizeShard {
+    Histogram rows[kSizedOps];
+    Histogram bytes_read[kSizedOps];
+    Histogram bytes_written[kSizedOps];
+  };
+  static int &ThreadKeyBucket() {
+    thread_local int bucket = -1;
+    return bucket;
+  }
+  uint64_t interval_cnt_{0};
+  uint64_t interval_ops_{0};
+  std::chrono::steady_clock::time_point interval_start_{std::chrono::steady_clock::now()};
+  uint64_t sample_interval_{1};
+  double sample_fraction_{1.0};
+  bool breakdown_{false};
+  bool perf_{false};
+  bool perf_kernel_{false};
+  std::mutex perf_mutex_;
+  PerfCount perf_count_[utils::MAXPERFCOUNTER] = {};
+  ThreadShards<StageShard> stage_shards_;
+  ThreadShards<ByteShard> byte_shards_;
+  size_t slow_top_k_{0};
+  uint64_t slow_threshold_{0};
+  size_t slow_max_traced_{0};
+  ThreadShards<SlowShard> slow_shards_;
+  std::vector<double> key_bucket_bounds_;
+  ThreadShards<KeyBucketShard> key_bucket_shards_;
+  ThreadShards<SizeShard> size_shards_;
 };
 
 class BasicMeasurements : public Measurements {
  public:
   BasicMeasurements();
   void Report(Operation op, uint64_t latency) override;
+  void ReportCount(Operation op) override;
   std::string GetStatusMsg() override;
+  std::vector<OperationSummary> GetSummary() override;
   void Reset() override;
  private:
-  std::atomic<uint> count_[MAXOPTYPE];
-  std::atomic<uint64_t> latency_sum_[MAXOPTYPE];
-  std::atomic<uint64_t> latency_min_[MAXOPTYPE];
-  std::atomic<uint64_t> latency_max_[MAXOPTYPE];
+  // written by the owning thread only, read by GetStatusMsg()
+  struct Shard {
+    Shard();
+    void Reset();
+    std::atomic<uint64_t> count[MAXOPTYPE];
+    std::atomic<uint64_t> samples[MAXOPTYPE];
+    std::atomic<uint64_t> latency_sum[MAXOPTYPE];
+    std::atomic<uint64_t> latency_min[MAXOPTYPE];
+    std::atomic<uint64_t> latency_max[MAXOPTYPE];
+  };
+  void Merge(Shard &merged);
+
+  ThreadShards<Shard> shards_;
 };
 
 #ifdef HDRMEASUREMENT
 class HdrHistogramMeasurements : public Measurements {
  public:
-  HdrHistogramMeasurements();
+  HdrHistogramMeasurements(utils::Properties *props);
+  ~HdrHistogramMeasurements();
   void Report(Operation op, uint64_t latency) override;
+  void ReportCount(Operation op) override;
   std::string GetStatusMsg() override;
+  std::vector<OperationSummary> GetSummary() override;
   void Reset() override;
  private:
-  hdr_histogram *histogram_[MAXOPTYPE];
+  struct Shard {
+    Shard();
+    ~Shard();
+    void Reset();
+    // exact operation counts, the histograms only hold sampled latencies
+    std::atomic<uint64_t> count[MAXOPTYPE];
+    hdr_histogram *histogram[MAXOPTYPE];
+  };
+  ThreadShards<Shard> shards_;
+  void MergeShards();
+  void LogInterval();
+
+  // sum of all shards, rebuilt by GetStatusMsg()
+  std::mutex merged_mutex_;
+  hdr_histogram *merged_[MAXOPTYPE];
+  uint64_t merged_count_[MAXOPTYPE];
+
+  // interval log, one file per operation type
+  bool log_intervals_;
+  std::string log_prefix_;
+  hdr_log_writer log_writer_;
+  hdr_timespec log_start_;
+  hdr_timespec interval_start_;
+  FILE *log_file_[MAXOPTYPE];
+  hdr_histogram *last_[MAXOPTYPE];
+  hdr_histogram *interval_[MAXOPTYPE];
 };
+
+///
+/// Sets result to the values recorded in a but not in b, bucket by bucket,
+/// for histograms with the same bucket layout where a holds all values of b.
+///
+void SubtractHistogram(hdr_histogram *result, const hdr_histogram *a, const hdr_histogram *b);
 #endif
 
 Measurements *CreateMeasurements(utils::Properties *props);
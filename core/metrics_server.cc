@@ -0,0 +1,224 @@
+//
+//  metrics_server.cc
+//  YCSB-cpp
+//
+
+#include "metrics_server.h"
+#include "utils/utils.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#if !defined(_MSC_VER)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace {
+  // how often the server thread checks whether it is stopped
+  const int kPollTimeoutMs = 200;
+  // a scraper that stalls longer than this is disconnected
+  const int kIoTimeoutSec = 5;
+
+  const char *const kByteCountString[ycsbc::MAXBYTECOUNT] = {
+    "inserted",
+    "updated",
+    "deleted",
+    "read"
+  };
+
+  std::string Labels(const std::string &phase, const char *name, const std::string &value) {
+    return "{phase=\"" + phase + "\"," + name + "=\"" + value + "\"}";
+  }
+
+  void Describe(std::ostream &os, const char *metric, const char *type, const char *help) {
+    os << "# HELP " << metric << ' ' << help << '\n';
+    os << "# TYPE " << metric << ' ' << type << '\n';
+  }
+} // anonymous
+
+namespace ycsbc {
+
+#if !defined(_MSC_VER)
+
+MetricsServer::MetricsServer(Measurements *measurements, const std::string &address, int port)
+    : measurements_(measurements), phase_start_(std::chrono::steady_clock::now()) {
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+    throw utils::Exception("invalid metrics address: " + address);
+  }
+  listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) {
+    throw utils::Exception(std::string("metrics socket: ") + strerror(errno));
+  }
+  int reuse = 1;
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      listen(listen_fd_, 16) != 0) {
+    std::string error = strerror(errno);
+    close(listen_fd_);
+    throw utils::Exception("failed to listen on " + address + ":" + std::to_string(port) + ": " +
+                           error);
+  }
+  thread_ = std::thread(&MetricsServer::Serve, this);
+}
+
+MetricsServer::~MetricsServer() {
+  stop_ = true;
+  thread_.join();
+  close(listen_fd_);
+}
+
+void MetricsServer::Serve() {
+  pollfd pfd{listen_fd_, POLLIN, 0};
+  while (!stop_) {
+    if (poll(&pfd, 1, kPollTimeoutMs) <= 0) {
+      continue;
+    }
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) {
+      continue;
+    }
+    timeval timeout{kIoTimeoutSec, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    HandleConnection(fd);
+    close(fd);
+  }
+}
+
+void MetricsServer::HandleConnection(int fd) {
+  // only the request line matters, the headers are read and dropped
+  std::string request;
+  char buf[1024];
+  while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) {
+      return;
+    }
+    request.append(buf, n);
+  }
+  std::istringstream request_line(request);
+  std::string method, target;
+  request_line >> method >> target;
+
+  std::string status = "200 OK";
+  std::string body;
+  if (method != "GET") {
+    status = "405 Method Not Allowed";
+  } else if (target != "/metrics") {
+    status = "404 Not Found";
+  } else {
+    body = Render();
+  }
+  std::string response = "HTTP/1.1 " + status + "\r\n"
+                         "Content-Type: text/plain; version=0.0.4\r\n"
+                         "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                         "Connection: close\r\n\r\n" + body;
+  for (size_t sent = 0; sent < response.size();) {
+    ssize_t n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      return;
+    }
+    sent += n;
+  }
+}
+
+#else
+
+MetricsServer::MetricsServer(Measurements *measurements, const std::string &address, int port)
+    : measurements_(measurements), listen_fd_(-1) {
+  throw utils::Exception("metrics endpoint is not supported on this platform");
+}
+
+MetricsServer::~MetricsServer() {
+}
+
+void MetricsServer::Serve() {
+}
+
+void MetricsServer::HandleConnection(int fd) {
+}
+
+#endif
+
+void MetricsServer::StartPhase(const std::string &phase) {
+  std::lock_guard<std::mutex> lock(phase_mutex_);
+  phase_ = phase;
+  phase_start_ = std::chrono::steady_clock::now();
+}
+
+std::string MetricsServer::Render() {
+  std::string phase;
+  std::chrono::duration<double> elapsed;
+  {
+    std::lock_guard<std::mutex> lock(phase_mutex_);
+    phase = phase_;
+    elapsed = std::chrono::steady_clock::now() - phase_start_;
+  }
+  std::vector<OperationSummary> summary = measurements_->GetSummary();
+  std::vector<uint64_t> bytes = measurements_->GetBytes();
+  const std::string phase_label = "{phase=\"" + phase + "\"}";
+
+  std::ostringstream os;
+  os.precision(3);
+  os << std::fixed;
+  uint64_t total = 0;
+  Describe(os, "ycsb_operations_total", "counter", "Operations completed in the current phase.");
+  for (const OperationSummary &s : summary) {
+    os << "ycsb_operations_total" << Labels(phase, "operation", kOperationString[s.op]) << ' '
+       << s.count << '\n';
+    // per-attempt measurements of transactions are not operations
+    if (s.op < TXN_COMMIT) {
+      total += s.count;
+    }
+  }
+  Describe(os, "ycsb_throughput_ops_per_second", "gauge",
+           "Average throughput since the start of the current phase.");
+  os << "ycsb_throughput_ops_per_second" << phase_label << ' '
+     << (elapsed.count() > 0 ? total / elapsed.count() : 0) << '\n';
+  Describe(os, "ycsb_phase_elapsed_seconds", "gauge", "Time since the start of the current phase.");
+  os << "ycsb_phase_elapsed_seconds" << phase_label << ' ' << elapsed.count() << '\n';
+
+  Describe(os, "ycsb_latency_microseconds", "summary",
+           "Latency of the sampled operations in the current phase.");
+  for (const OperationSummary &s : summary) {
+    const std::string op = kOperationString[s.op];
+    for (size_t i = 0; i < s.percentiles.size(); i++) {
+      std::ostringstream quantile;
+      quantile << kSummaryPercentiles[i] / 100;
+      os << "ycsb_latency_microseconds{phase=\"" << phase << "\",operation=\"" << op
+         << "\",quantile=\"" << quantile.str() << "\"} " << s.percentiles[i] / 1000.0 << '\n';
+    }
+    os << "ycsb_latency_microseconds_sum" << Labels(phase, "operation", op) << ' '
+       << s.mean * s.samples / 1000.0 << '\n';
+    os << "ycsb_latency_microseconds_count" << Labels(phase, "operation", op) << ' '
+       << s.samples << '\n';
+  }
+  Describe(os, "ycsb_latency_max_microseconds", "gauge",
+           "Maximum latency of the sampled operations in the current phase.");
+  for (const OperationSummary &s : summary) {
+    if (s.samples > 0) {
+      os << "ycsb_latency_max_microseconds" << Labels(phase, "operation", kOperationString[s.op])
+         << ' ' << s.max / 1000.0 << '\n';
+    }
+  }
+
+  Describe(os, "ycsb_bytes_total", "counter",
+           "Logical bytes of keys, field names and values moved by successful operations.");
+  for (int kind = 0; kind < MAXBYTECOUNT; kind++) {
+    os << "ycsb_bytes_total" << Labels(phase, "kind", kByteCountString[kind]) << ' '
+       << bytes[kind] << '\n';
+  }
+  return os.str();
+}
+
+} // ycsbc
@@ -0,0 +1,60 @@
+//
+//  metrics_server.h
+//  YCSB-cpp
+//
+
+#ifndef YCSB_C_METRICS_SERVER_H_
+#define YCSB_C_METRICS_SERVER_H_
+
+#include "measurements.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace ycsbc {
+
+///
+/// HTTP endpoint serving the live measurements of the current phase in the
+/// Prometheus text format on GET /metrics.
+/// Scrapes run on the server thread and only read the per-thread
+/// measurement shards, so client threads never wait for them.
+///
+class MetricsServer {
+ public:
+  ///
+  /// Starts listening on address:port.
+  /// Throws utils::Exception if the socket cannot be bound.
+  ///
+  MetricsServer(Measurements *measurements, const std::string &address, int port);
+  ~MetricsServer();
+
+  MetricsServer(const MetricsServer &) = delete;
+  MetricsServer &operator=(const MetricsServer &) = delete;
+
+  ///
+  /// Labels the following scrapes with phase and measures its throughput
+  /// from now on. Called when the measurements are reset for a new phase.
+  ///
+  void StartPhase(const std::string &phase);
+
+ private:
+  void Serve();
+  void HandleConnection(int fd);
+  std::string Render();
+
+  Measurements *measurements_;
+  int listen_fd_;
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+
+  std::mutex phase_mutex_;
+  std::string phase_;
+  std::chrono::steady_clock::time_point phase_start_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_METRICS_SERVER_H_
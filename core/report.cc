@@ -0,0 +1,524 @@
+//
+//  report.cc
+//  YCSB-cpp
+//
+
+#include "report.h"
+#include "utils/utils.h"
+
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+  std::string PercentileName(double p) {
+    std::ostringstream name;
+    name << p;
+    return name.str();
+  }
+
+  std::string JsonString(const std::string &s) {
+    std::ostringstream out;
+    out << '"';
+    for (char c : s) {
+      switch (c) {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out << buf;
+          } else {
+            out << c;
+          }
+      }
+    }
+    out << '"';
+    return out.str();
+  }
+
+  std::string JsonRatio(double ratio) {
+    if (ratio < 0) {
+      return "null";
+    }
+    std::ostringstream out;
+    out.precision(6);
+    out << std::fixed << ratio;
+    return out.str();
+  }
+
+  // local time with microseconds, to match against engine logs
+  std::string FormatTime(std::chrono::system_clock::time_point time) {
+    std::time_t t = std::chrono::system_clock::to_time_t(time);
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()) %
+              std::chrono::seconds(1);
+    std::ostringstream out;
+    out << std::put_time(std::localtime(&t), "%F %T") << '.' << std::setfill('0')
+        << std::setw(6) << us.count();
+    return out.str();
+  }
+
+  struct BreakdownEntry {
+    const char *name;
+    uint64_t time;
+  };
+
+  // client loop time split into the timed stages; other is the part of the
+  // operations outside of them, such as choosing the operation and the
+  // fields and measuring the DB call
+  std::vector<BreakdownEntry> SplitBreakdown(const std::vector<uint64_t> &t) {
+    uint64_t timed = 0;
+    for (int stage = ycsbc::STAGE_DB; stage < ycsbc::MAXSTAGE; stage++) {
+      timed += t[stage];
+    }
+    uint64_t other = t[ycsbc::STAGE_OPERATION] > timed ? t[ycsbc::STAGE_OPERATION] - timed : 0;
+    return {{"Throttle", t[ycsbc::STAGE_THROTTLE]},
+            {"KeyChoice", t[ycsbc::STAGE_KEY_CHOICE]},
+            {"GeneratorLock", t[ycsbc::STAGE_GENERATOR_LOCK]},
+            {"BuildKey", t[ycsbc::STAGE_BUILD_KEY]},
+            {"BuildValues", t[ycsbc::STAGE_BUILD_VALUES]},
+            {"DB", t[ycsbc::STAGE_DB]},
+            {"KeyAcknowledge", t[ycsbc::STAGE_KEY_ACK]},
+            {"Other", other}};
+  }
+
+  struct Amplification {
+    uint64_t logical_written;
+    uint64_t logical_read;
+    // ratios of physical to logical bytes, negative if undefined
+    double write;
+    double read;
+    double space;
+  };
+
+  double Ratio(uint64_t physical, uint64_t logical) {
+    return logical ? static_cast<double>(physical) / logical : -1;
+  }
+
+  Amplification ComputeAmplification(const ycsbc::PhaseReport &report) {
+    Amplification a;
+    a.logical_written = report.bytes[ycsbc::BYTES_INSERTED] + report.bytes[ycsbc::BYTES_UPDATED] +
+                        report.bytes[ycsbc::BYTES_DELETED];
+    a.logical_read = report.bytes[ycsbc::BYTES_READ];
+    a.write = Ratio(report.resources.io_write_bytes, a.logical_written);
+    a.read = Ratio(report.resources.io_read_bytes, a.logical_read);
+    a.space = report.disk_usage ? Ratio(report.disk_usage, report.logical_size) : -1;
+    return a;
+  }
+
+  double PerOp(double value, uint64_t ops) {
+    return ops ? value / ops : 0;
+  }
+
+  std::string BucketLabel(ycsbc::Operation op, const ycsbc::KeyBucketSummary &bucket) {
+    return std::string(ycsbc::kOperationString[op]) + " " + bucket.name;
+  }
+
+  void PrintOperation(std::ostream &os, const std::string &label,
+                      const ycsbc::OperationSummary &s, double runtime) {
+    const std::string prefix = "[" + label + "], ";
+    os << prefix << "Operations, " << s.count << std::endl;
+    os << prefix << "Throughput(ops/sec), " << s.count / runtime << std::endl;
+    if (s.samples != s.count) {
+      os << prefix << "LatencySampleRate, " << static_cast<double>(s.samples) / s.count << std::endl;
+    }
+    if (s.samples == 0) {
+      return;
+    }
+    os << prefix << "AverageLatency(us), " << s.mean / 1000.0 << std::endl;
+    os << prefix << "MinLatency(us), " << s.min / 1000.0 << std::endl;
+    os << prefix << "MaxLatency(us), " << s.max / 1000.0 << std::endl;
+    for (size_t i = 0; i < s.percentiles.size(); i++) {
+      os << prefix << PercentileName(ycsbc::kSummaryPercentiles[i]) << "thPercentileLatency(us), "
+         << s.percentiles[i] / 1000.0 << std::endl;
+    }
+  }
+
+  bool ReadsRecords(ycsbc::Operation op) {
+    return op == ycsbc::READ || op == ycsbc::SCAN || op == ycsbc::READMODIFYWRITE ||
+           op == ycsbc::TXN;
+  }
+
+  bool WritesRecords(ycsbc::Operation op) {
+    return op != ycsbc::READ && op != ycsbc::SCAN;
+  }
+
+  void PrintDistribution(std::ostream &os, const std::string &prefix, const char *name,
+                         const ycsbc::DistributionSummary &d) {
+    os << prefix << "Average" << name << ", " << d.mean << std::endl;
+    os << prefix << "Min" << name << ", " << d.min << std::endl;
+    os << prefix << "Max" << name << ", " << d.max << std::endl;
+    for (size_t i = 0; i < d.percentiles.size(); i++) {
+      os << prefix << PercentileName(ycsbc::kSummaryPercentiles[i]) << "thPercentile" << name
+         << ", " << d.percentiles[i] << std::endl;
+    }
+  }
+
+  void WriteDistributionJson(std::ostream &os, const ycsbc::DistributionSummary &d) {
+    os << "{\"mean\": " << d.mean << ", \"min\": " << d.min << ", \"max\": " << d.max
+       << ", \"percentiles\": {";
+    for (size_t i = 0; i < d.percentiles.size(); i++) {
+      os << (i ? ", " : "") << '"' << PercentileName(ycsbc::kSummaryPercentiles[i]) << "\": "
+         << d.percentiles[i];
+    }
+    os << "}}";
+  }
+
+  void WriteOperationJson(std::ostream &os, const ycsbc::OperationSummary &s, double runtime) {
+    os << "{"
+       << "\"operation\": " << JsonString(ycsbc::kOperationString[s.op])
+       << ", \"count\": " << s.count
+       << ", \"latency_samples\": " << s.samples
+       << ", \"throughput_ops_sec\": " << s.count / runtime
+       << ", \"mean_us\": " << s.mean / 1000.0
+       << ", \"min_us\": " << s.min / 1000.0
+       << ", \"max_us\": " << s.max / 1000.0
+       << ", \"percentiles_us\": {";
+    for (size_t i = 0; i < s.percentiles.size(); i++) {
+      os << (i ? ", " : "") << '"' << PercentileName(ycsbc::kSummaryPercentiles[i]) << "\": "
+         << s.percentiles[i] / 1000.0;
+    }
+    os << "}}";
+  }
+
+  void WriteOperationCsv(std::ostream &os, const std::string &phase, const std::string &label,
+                         const ycsbc::OperationSummary &s, double runtime) {
+    const size_t num_percentiles = sizeof(ycsbc::kSummaryPercentiles) /
+                                   sizeof(ycsbc::kSummaryPercentiles[0]);
+    os << phase << ',' << label << ',' << s.count << ',' << s.samples << ',' << s.count / runtime
+       << ',' << s.mean / 1000.0 << ',' << s.min / 1000.0 << ',' << s.max / 1000.0;
+    for (size_t i = 0; i < num_percentiles; i++) {
+      os << ',';
+      if (i < s.percentiles.size()) {
+        os << s.percentiles[i] / 1000.0;
+      }
+    }
+    os << '\n';
+  }
+
+  // quoted as in RFC 4180 when the value holds a separator, quote or newline
+  std::string CsvField(const std::string &s) {
+    if (s.find_first_of(",\"\r\n") == std::string::npos) {
+      return s;
+    }
+    std::string quoted = "\"";
+    for (char c : s) {
+      if (c == '"') {
+        quoted += '"';
+      }
+      quoted += c;
+    }
+    return quoted + '"';
+  }
+
+  // results.csv -> results.config.csv
+  std::string CsvConfigPath(const std::string &path) {
+    const std::string ext = ".csv";
+    if (path.size() > ext.size() && path.compare(path.size() - ext.size(), ext.size(), ext) == 0) {
+      return path.substr(0, path.size() - ext.size()) + ".config" + ext;
+    }
+    return path + ".config" + ext;
+  }
+
+  std::ofstream OpenExportFile(const std::string &path) {
+    std::ofstream ofs(path);
+    if (!ofs.is_open()) {
+      throw ycsbc::utils::Exception("failed to open: " + path);
+    }
+    ofs.precision(6);
+    ofs << std::fixed;
+    return ofs;
+  }
+} // anonymous
+
+namespace ycsbc {
+
+void PrintReport(std::ostream &os, const PhaseReport &report) {
+  for (const OperationSummary &s : report.measurements) {
+    PrintOperation(os, kOperationString[s.op], s, report.runtime);
+  }
+  for (const KeyBucketSummary &bucket : report.key_buckets) {
+    for (const OperationSummary &s : bucket.measurements) {
+      PrintOperation(os, BucketLabel(s.op, bucket), s, report.runtime);
+    }
+  }
+  for (const SizeSummary &s : report.sizes) {
+    const std::string prefix = std::string("[") + kOperationString[s.op] + "], ";
+    os << prefix << "Throughput(MB/sec), "
+       << (s.bytes_read + s.bytes_written) / 1048576.0 / report.runtime << std::endl;
+    // every other operation is on a single row
+    if (s.op == SCAN || s.op == TXN) {
+      PrintDistribution(os, prefix, "Rows", s.rows_per_op);
+    }
+    if (ReadsRecords(s.op)) {
+      PrintDistribution(os, prefix, "BytesRead", s.bytes_read_per_op);
+    }
+    if (WritesRecords(s.op)) {
+      PrintDistribution(os, prefix, "BytesWritten", s.bytes_written_per_op);
+    }
+  }
+  const utils::ResourceUsage &r = report.resources;
+  const double cpu_time = r.user_time + r.system_time;
+  os << "[PROCESS], UserTime(sec), " << r.user_time << std::endl;
+  os << "[PROCESS], SystemTime(sec), " << r.system_time << std::endl;
+  os << "[PROCESS], CPUUtilization(cores), " << cpu_time / report.runtime << std::endl;
+  os << "[PROCESS], CPUSecondsPerMillionOps, " << PerOp(cpu_time * 1e6, report.operations)
+     << std::endl;
+  os << "[PROCESS], RSS(MB), " << r.rss / 1048576.0 << std::endl;
+  os << "[PROCESS], PeakRSS(MB), " << r.peak_rss / 1048576.0 << std::endl;
+  os << "[PROCESS], VoluntaryContextSwitchesPerOp, " << PerOp(r.voluntary_cs, report.operations)
+     << std::endl;
+  os << "[PROCESS], InvoluntaryContextSwitchesPerOp, "
+     << PerOp(r.involuntary_cs, report.operations) << std::endl;
+  const Amplification a = ComputeAmplification(report);
+  os << "[AMPLIFICATION], LogicalBytesWritten, " << a.logical_written << std::endl;
+  os << "[AMPLIFICATION], PhysicalBytesWritten, " << r.io_write_bytes << std::endl;
+  os << "[AMPLIFICATION], LogicalBytesRead, " << a.logical_read << std::endl;
+  os << "[AMPLIFICATION], PhysicalBytesRead, " << r.io_read_bytes << std::endl;
+  os << "[AMPLIFICATION], LogicalSize(bytes), " << report.logical_size << std::endl;
+  if (report.disk_usage) {
+    os << "[AMPLIFICATION], DiskUsage(bytes), " << report.disk_usage << std::endl;
+  }
+  if (a.write >= 0) {
+    os << "[AMPLIFICATION], WriteAmplification, " << a.write << std::endl;
+  }
+  if (a.read >= 0) {
+    os << "[AMPLIFICATION], ReadAmplification, " << a.read << std::endl;
+  }
+  if (a.space >= 0) {
+    os << "[AMPLIFICATION], SpaceAmplification, " << a.space << std::endl;
+  }
+  const CacheSummary &cache = report.cache;
+  if (cache.capacity) {
+    const uint64_t lookups = cache.hits + cache.misses;
+    os << "[CACHE], Hits, " << cache.hits << std::endl;
+    os << "[CACHE], Misses, " << cache.misses << std::endl;
+    os << "[CACHE], HitRatio, " << (lookups ? double(cache.hits) / lookups : 0) << std::endl;
+    os << "[CACHE], Usage(bytes), " << cache.usage << std::endl;
+    os << "[CACHE], Capacity(bytes), " << cache.capacity << std::endl;
+    os << "[CACHE], Entries, " << cache.entries << std::endl;
+  }
+  if (!report.perf.empty()) {
+    for (int c = 0; c < utils::MAXPERFCOUNTER; c++) {
+      const PerfCount &count = report.perf[c];
+      if (count.ops) {
+        os << "[PERF], " << utils::kPerfCounterString[c] << "/op, "
+           << PerOp(count.value, count.ops) << std::endl;
+      }
+    }
+    const PerfCount &cycles = report.perf[utils::PERF_CYCLES];
+    const PerfCount &instructions = report.perf[utils::PERF_INSTRUCTIONS];
+    if (cycles.value && instructions.ops) {
+      os << "[PERF], IPC, " << static_cast<double>(instructions.value) / cycles.value << std::endl;
+    }
+  }
+  for (const SlowOperation &slow : report.slow_operations) {
+    os << "[SLOW-OP], " << FormatTime(slow.time) << ", " << kOperationString[slow.op] << ", "
+       << slow.key << ", " << (slow.fields.empty() ? "*" : slow.fields) << ", " << slow.bytes
+       << " bytes, " << slow.latency / 1000.0 << " us" << std::endl;
+  }
+  if (report.breakdown.empty()) {
+    return;
+  }
+  uint64_t total = report.breakdown[STAGE_THROTTLE] + report.breakdown[STAGE_OPERATION];
+  for (const BreakdownEntry &e : SplitBreakdown(report.breakdown)) {
+    os << "[BREAKDOWN], " << e.name << "(us/op), " << PerOp(e.time / 1000.0, report.operations)
+       << std::endl;
+    os << "[BREAKDOWN], " << e.name << "(%), "
+       << (total ? 100.0 * e.time / total : 0) << std::endl;
+  }
+}
+
+std::string ResourceStatusMsg(const utils::ResourceUsage &usage, uint64_t ops) {
+  std::ostringstream msg_stream;
+  msg_stream.precision(2);
+  msg_stream << std::fixed << "[PROCESS:"
+             << " User=" << usage.user_time << "s"
+             << " Sys=" << usage.system_time << "s"
+             << " CPUsec/Mops=" << PerOp((usage.user_time + usage.system_time) * 1e6, ops)
+             << " RSS=" << usage.rss / 1048576.0 << "MB"
+             << " PeakRSS=" << usage.peak_rss / 1048576.0 << "MB"
+             // usually far below one per operation
+             << std::setprecision(3) << std::defaultfloat
+             << " VCS/op=" << PerOp(usage.voluntary_cs, ops)
+             << " ICS/op=" << PerOp(usage.involuntary_cs, ops) << "]";
+  return msg_stream.str();
+}
+
+void ExportJson(const std::string &path, const utils::Properties &props,
+                const std::vector<PhaseReport> &reports) {
+  std::ofstream ofs = OpenExportFile(path);
+  ofs << "{\n  \"properties\": {";
+  const char *sep = "\n";
+  for (const auto &p : props.EffectiveProperties()) {
+    ofs << sep << "    " << JsonString(p.first) << ": " << JsonString(p.second);
+    sep = ",\n";
+  }
+  ofs << "\n  },\n  \"phases\": [";
+  sep = "\n";
+  for (const PhaseReport &report : reports) {
+    ofs << sep << "    {\n"
+        << "      \"phase\": " << JsonString(report.phase) << ",\n"
+        << "      \"runtime_sec\": " << report.runtime << ",\n"
+        << "      \"operations\": " << report.operations << ",\n"
+        << "      \"throughput_ops_sec\": " << report.operations / report.runtime << ",\n";
+    const utils::ResourceUsage &r = report.resources;
+    ofs << "      \"resources\": {"
+        << "\"user_sec\": " << r.user_time
+        << ", \"system_sec\": " << r.system_time
+        << ", \"cpu_sec_per_million_ops\": "
+        << PerOp((r.user_time + r.system_time) * 1e6, report.operations)
+        << ", \"rss_bytes\": " << r.rss
+        << ", \"peak_rss_bytes\": " << r.peak_rss
+        << ", \"voluntary_context_switches\": " << r.voluntary_cs
+        << ", \"involuntary_context_switches\": " << r.involuntary_cs << "},\n";
+    const Amplification a = ComputeAmplification(report);
+    ofs << "      \"amplification\": {"
+        << "\"logical_bytes_written\": " << a.logical_written
+        << ", \"physical_bytes_written\": " << r.io_write_bytes
+        << ", \"logical_bytes_read\": " << a.logical_read
+        << ", \"physical_bytes_read\": " << r.io_read_bytes
+        << ", \"logical_size_bytes\": " << report.logical_size
+        << ", \"disk_usage_bytes\": " << report.disk_usage
+        << ", \"write\": " << JsonRatio(a.write)
+        << ", \"read\": " << JsonRatio(a.read)
+        << ", \"space\": " << JsonRatio(a.space) << "},\n";
+    const CacheSummary &cache = report.cache;
+    if (cache.capacity) {
+      const uint64_t lookups = cache.hits + cache.misses;
+      ofs << "      \"cache\": {"
+          << "\"hits\": " << cache.hits
+          << ", \"misses\": " << cache.misses
+          << ", \"hit_ratio\": " << JsonRatio(lookups ? double(cache.hits) / lookups : -1)
+          << ", \"usage_bytes\": " << cache.usage
+          << ", \"capacity_bytes\": " << cache.capacity
+          << ", \"entries\": " << cache.entries << "},\n";
+    }
+    if (!report.perf.empty()) {
+      ofs << "      \"perf_per_op\": {";
+      const char *counter_sep = "";
+      for (int c = 0; c < utils::MAXPERFCOUNTER; c++) {
+        const PerfCount &count = report.perf[c];
+        if (count.ops) {
+          ofs << counter_sep << JsonString(utils::kPerfCounterString[c]) << ": "
+              << PerOp(count.value, count.ops);
+          counter_sep = ", ";
+        }
+      }
+      ofs << "},\n";
+    }
+    if (!report.breakdown.empty()) {
+      ofs << "      \"breakdown_us\": {";
+      const char *stage_sep = "";
+      for (const BreakdownEntry &e : SplitBreakdown(report.breakdown)) {
+        ofs << stage_sep << JsonString(e.name) << ": " << e.time / 1000.0;
+        stage_sep = ", ";
+      }
+      ofs << "},\n";
+    }
+    if (!report.slow_operations.empty()) {
+      ofs << "      \"slow_operations\": [";
+      const char *slow_sep = "\n";
+      for (const SlowOperation &slow : report.slow_operations) {
+        ofs << slow_sep << "        {"
+            << "\"time\": " << JsonString(FormatTime(slow.time))
+            << ", \"operation\": " << JsonString(kOperationString[slow.op])
+            << ", \"key\": " << JsonString(slow.key)
+            << ", \"fields\": " << JsonString(slow.fields)
+            << ", \"bytes\": " << slow.bytes
+            << ", \"latency_us\": " << slow.latency / 1000.0 << "}";
+        slow_sep = ",\n";
+      }
+      ofs << "\n      ],\n";
+    }
+    if (!report.sizes.empty()) {
+      ofs << "      \"sizes\": [";
+      const char *size_sep = "\n";
+      for (const SizeSummary &s : report.sizes) {
+        ofs << size_sep << "        {"
+            << "\"operation\": " << JsonString(kOperationString[s.op])
+            << ", \"count\": " << s.count
+            << ", \"bytes_read\": " << s.bytes_read
+            << ", \"bytes_written\": " << s.bytes_written
+            << ", \"throughput_mb_sec\": "
+            << (s.bytes_read + s.bytes_written) / 1048576.0 / report.runtime
+            << ", \"rows_per_op\": ";
+        WriteDistributionJson(ofs, s.rows_per_op);
+        if (ReadsRecords(s.op)) {
+          ofs << ", \"bytes_read_per_op\": ";
+          WriteDistributionJson(ofs, s.bytes_read_per_op);
+        }
+        if (WritesRecords(s.op)) {
+          ofs << ", \"bytes_written_per_op\": ";
+          WriteDistributionJson(ofs, s.bytes_written_per_op);
+        }
+        ofs << "}";
+        size_sep = ",\n";
+      }
+      ofs << "\n      ],\n";
+    }
+    if (!report.key_buckets.empty()) {
+      ofs << "      \"key_buckets\": [";
+      const char *bucket_sep = "\n";
+      for (const KeyBucketSummary &bucket : report.key_buckets) {
+        ofs << bucket_sep << "        {\"bucket\": " << JsonString(bucket.name)
+            << ", \"measurements\": [";
+        const char *op_sep = "\n";
+        for (const OperationSummary &s : bucket.measurements) {
+          ofs << op_sep << "          ";
+          WriteOperationJson(ofs, s, report.runtime);
+          op_sep = ",\n";
+        }
+        ofs << "\n        ]}";
+        bucket_sep = ",\n";
+      }
+      ofs << "\n      ],\n";
+    }
+    ofs << "      \"measurements\": [";
+    const char *op_sep = "\n";
+    for (const OperationSummary &s : report.measurements) {
+      ofs << op_sep << "        ";
+      WriteOperationJson(ofs, s, report.runtime);
+      op_sep = ",\n";
+    }
+    ofs << "\n      ]\n    }";
+    sep = ",\n";
+  }
+  ofs << "\n  ]\n}\n";
+}
+
+void ExportCsv(const std::string &path, const utils::Properties &props,
+               const std::vector<PhaseReport> &reports) {
+  std::ofstream config = OpenExportFile(CsvConfigPath(path));
+  config << "property,value\n";
+  for (const auto &p : props.EffectiveProperties()) {
+    config << CsvField(p.first) << ',' << CsvField(p.second) << '\n';
+  }
+  std::ofstream ofs = OpenExportFile(path);
+  ofs << "phase,operation,count,latency_samples,throughput_ops_sec,mean_us,min_us,max_us";
+  for (double p : kSummaryPercentiles) {
+    ofs << ",p" << PercentileName(p) << "_us";
+  }
+  ofs << '\n';
+  const size_t num_percentiles = sizeof(kSummaryPercentiles) / sizeof(kSummaryPercentiles[0]);
+  for (const PhaseReport &report : reports) {
+    ofs << report.phase << ",OVERALL," << report.operations << ",,"
+        << report.operations / report.runtime << ",,,";
+    ofs << std::string(num_percentiles, ',') << '\n';
+    for (const OperationSummary &s : report.measurements) {
+      WriteOperationCsv(ofs, report.phase, kOperationString[s.op], s, report.runtime);
+    }
+    for (const KeyBucketSummary &bucket : report.key_buckets) {
+      for (const OperationSummary &s : bucket.measurements) {
+        WriteOperationCsv(ofs, report.phase, BucketLabel(s.op, bucket), s, report.runtime);
+      }
+    }
+  }
+}
+
+} // ycsbc
@@ -0,0 +1,81 @@
+//
+//  report.h
+//  YCSB-cpp
+//
+
+#ifndef YCSB_C_REPORT_H_
+#define YCSB_C_REPORT_H_
+
+#include "cache_db.h"
+#include "measurements.h"
+#include "utils/properties.h"
+#include "utils/resource_usage.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ycsbc {
+
+///
+/// Result of one phase of the benchmark.
+///
+struct PhaseReport {
+  std::string phase;
+  double runtime;
+  uint64_t operations;
+  std::vector<OperationSummary> measurements;
+  // nanoseconds per Stage summed over all threads, empty if not measured
+  std::vector<uint64_t> breakdown;
+  // process resources used during the phase
+  utils::ResourceUsage resources;
+  // logical bytes per ByteCount
+  std::vector<uint64_t> bytes;
+  // logical size of all records inserted up to the end of the phase
+  uint64_t logical_size;
+  // size of the database on disk at the end of the phase, 0 if unknown
+  uint64_t disk_usage;
+  // total per utils::PerfCounter, empty if not measured
+  std::vector<PerfCount> perf;
+  // slowest first, empty if not traced
+  std::vector<SlowOperation> slow_operations;
+  // sampled latencies per key popularity bucket, empty if not bucketed
+  std::vector<KeyBucketSummary> key_buckets;
+  // rows and bytes of the successful operations
+  std::vector<SizeSummary> sizes;
+  // use of the client cache
+  CacheSummary cache;
+};
+
+///
+/// Prints the per-operation latencies, overall and per key popularity
+/// bucket, the per-operation sizes, the overhead breakdown, the resource usage, the amplification,
+/// the use of the client cache, the performance counters and the slow operations of a phase.
+///
+void PrintReport(std::ostream &os, const PhaseReport &report);
+
+///
+/// Formats the resource usage of a status interval in which ops operations
+/// completed.
+///
+std::string ResourceStatusMsg(const utils::ResourceUsage &usage, uint64_t ops);
+
+///
+/// Writes the reports of all phases and the effective properties of the run,
+/// defaults included, as JSON.
+///
+void ExportJson(const std::string &path, const utils::Properties &props,
+                const std::vector<PhaseReport> &reports);
+
+///
+/// Writes one row per phase and operation, and per operation and key
+/// popularity bucket, as CSV. The effective properties of the run go to a
+/// sibling file with ".config.csv" in place of the ".csv" extension, one
+/// "property,value" row each.
+///
+void ExportCsv(const std::string &path, const utils::Properties &props,
+               const std::vector<PhaseReport> &reports);
+
+} // ycsbc
+
+#endif // YCSB_C_REPORT_H_
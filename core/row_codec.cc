@@ -0,0 +1,239 @@
+//
+//  row_codec.cc
+//  YCSB-cpp
+//
+
+#include "row_codec.h"
+#include "core_workload.h"
+#include "utils/utils.h"
+
+#include <cstring>
+
+namespace {
+  const std::string PROP_VARINT_LENGTHS = "row.varintlengths";
+  const std::string PROP_VARINT_LENGTHS_DEFAULT = "false";
+
+  void PutVarint(std::string &data, uint64_t v) {
+    while (v >= 0x80) {
+      data.push_back(static_cast<char>(v | 0x80));
+      v >>= 7;
+    }
+    data.push_back(static_cast<char>(v));
+  }
+
+  uint64_t GetVarint(const char *&p, const char *lim) {
+    uint64_t v = 0;
+    for (int shift = 0; p < lim && shift < 64; shift += 7) {
+      uint8_t byte = static_cast<uint8_t>(*p++);
+      v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return v;
+      }
+    }
+    throw ycsbc::utils::Exception("corrupt row");
+  }
+
+  uint32_t GetFixed32(const char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  void PutFixed32(std::string &data, uint32_t v) {
+    data.append(reinterpret_cast<const char *>(&v), sizeof(v));
+  }
+} // anonymous
+
+namespace ycsbc {
+
+RowCodec::RowCodec(const utils::Properties &props)
+    : field_prefix_(props.GetProperty(CoreWorkload::FIELD_NAME_PREFIX,
+                                      CoreWorkload::FIELD_NAME_PREFIX_DEFAULT)),
+      varint_lengths_(utils::StrToBool(props.GetProperty(PROP_VARINT_LENGTHS,
+                                                         PROP_VARINT_LENGTHS_DEFAULT))) {
+  const size_t field_count = std::stoul(props.GetProperty(CoreWorkload::FIELD_COUNT_PROPERTY,
+                                                          CoreWorkload::FIELD_COUNT_DEFAULT));
+  for (size_t i = 0; i < field_count; i++) {
+    names_.push_back(field_prefix_ + std::to_string(i));
+  }
+}
+
+size_t RowCodec::FieldId(std::string_view name) const {
+  size_t id = 0;
+  bool valid = name.size() > field_prefix_.size() &&
+               name.compare(0, field_prefix_.size(), field_prefix_) == 0;
+  for (size_t i = field_prefix_.size(); valid && i < name.size(); i++) {
+    valid = name[i] >= '0' && name[i] <= '9';
+    id = id * 10 + (name[i] - '0');
+  }
+  if (!valid || id >= names_.size()) {
+    throw utils::Exception("unknown field: " + std::string(name));
+  }
+  return id;
+}
+
+RowCodec::Layout RowCodec::Parse(const char *p, const char *lim) const {
+  if (p == lim) {
+    throw utils::Exception("corrupt row");
+  }
+  Layout row;
+  row.flags = static_cast<uint8_t>(*p++);
+  row.count = GetVarint(p, lim);
+  row.ids = p;
+  if (row.flags & kSparse) {
+    for (uint64_t i = 0; i < row.count; i++) {
+      GetVarint(p, lim);
+    }
+  }
+  row.offsets = p;
+  row.values = (row.flags & kVarintLengths) ? p : p + row.count * sizeof(uint32_t);
+  row.lim = lim;
+  return row;
+}
+
+template <typename F>
+void RowCodec::ForEach(const Layout &row, F f) const {
+  const char *id_p = row.ids;
+  const char *value_p = row.values;
+  uint32_t start = 0;
+  for (uint64_t i = 0; i < row.count; i++) {
+    size_t id = (row.flags & kSparse) ? GetVarint(id_p, row.values) : i;
+    if (id >= names_.size()) {
+      throw utils::Exception("corrupt row: field index " + std::to_string(id));
+    }
+    if (row.flags & kVarintLengths) {
+      uint64_t len = GetVarint(value_p, row.lim);
+      f(id, std::string_view(value_p, len));
+      value_p += len;
+    } else {
+      uint32_t end = GetFixed32(row.offsets + i * sizeof(uint32_t));
+      f(id, std::string_view(row.values + start, end - start));
+      start = end;
+    }
+  }
+}
+
+bool RowCodec::Find(const Layout &row, size_t id, std::string_view *value) const {
+  if (!(row.flags & (kSparse | kVarintLengths))) {
+    if (id >= row.count) {
+      return false;
+    }
+    uint32_t start = id ? GetFixed32(row.offsets + (id - 1) * sizeof(uint32_t)) : 0;
+    uint32_t end = GetFixed32(row.offsets + id * sizeof(uint32_t));
+    *value = std::string_view(row.values + start, end - start);
+    return true;
+  }
+  bool found = false;
+  ForEach(row, [&](size_t field_id, std::string_view field_value) {
+    if (!found && field_id == id) {
+      *value = field_value;
+      found = true;
+    }
+  });
+  return found;
+}
+
+void RowCodec::Encode(const std::vector<DB::Field> &values, std::string &data) const {
+  std::vector<std::pair<size_t, std::string_view>> fields;
+  fields.reserve(values.size());
+  for (const DB::Field &field : values) {
+    fields.emplace_back(FieldId(field.name), field.value);
+  }
+  Write(fields, data);
+}
+
+void RowCodec::Write(const std::vector<std::pair<size_t, std::string_view>> &fields,
+                     std::string &data) const {
+  bool sparse = fields.size() != names_.size();
+  for (size_t i = 0; !sparse && i < fields.size(); i++) {
+    sparse = fields[i].first != i;
+  }
+  data.push_back(static_cast<char>((sparse ? kSparse : 0) | (varint_lengths_ ? kVarintLengths : 0)));
+  PutVarint(data, fields.size());
+  if (sparse) {
+    for (const auto &field : fields) {
+      PutVarint(data, field.first);
+    }
+  }
+  if (varint_lengths_) {
+    for (const auto &field : fields) {
+      PutVarint(data, field.second.size());
+      data.append(field.second.data(), field.second.size());
+    }
+    return;
+  }
+  uint32_t end = 0;
+  for (const auto &field : fields) {
+    end += field.second.size();
+    PutFixed32(data, end);
+  }
+  for (const auto &field : fields) {
+    data.append(field.second.data(), field.second.size());
+  }
+}
+
+void RowCodec::Decode(const char *p, const char *lim, const std::vector<std::string> *fields,
+                      std::vector<DB::Field> &values) const {
+  const Layout row = Parse(p, lim);
+  values.reserve(values.size() + (fields ? fields->size() : row.count));
+  if (fields == nullptr) {
+    ForEach(row, [&](size_t id, std::string_view value) {
+      values.push_back({names_[id], std::string(value)});
+    });
+    return;
+  }
+  for (const std::string &name : *fields) {
+    std::string_view value;
+    if (Find(row, FieldId(name), &value)) {
+      values.push_back({name, std::string(value)});
+    }
+  }
+}
+
+void RowCodec::DecodeView(const char *p, const char *lim, const std::vector<std::string> *fields,
+                          std::vector<DB::FieldView> &values) const {
+  const Layout row = Parse(p, lim);
+  values.reserve(values.size() + (fields ? fields->size() : row.count));
+  if (fields == nullptr) {
+    ForEach(row, [&](size_t id, std::string_view value) {
+      values.push_back({names_[id], value});
+    });
+    return;
+  }
+  for (const std::string &name : *fields) {
+    std::string_view value;
+    if (Find(row, FieldId(name), &value)) {
+      values.push_back({name, value});
+    }
+  }
+}
+
+void RowCodec::Update(const char *p, const char *lim, const std::vector<DB::Field> &values,
+                      std::string &data) const {
+  const Layout row = Parse(p, lim);
+  std::vector<size_t> new_ids;
+  new_ids.reserve(values.size());
+  for (const DB::Field &field : values) {
+    new_ids.push_back(FieldId(field.name));
+  }
+  std::vector<std::pair<size_t, std::string_view>> fields;
+  fields.reserve(row.count + values.size());
+  std::vector<bool> replaced(values.size());
+  ForEach(row, [&](size_t id, std::string_view value) {
+    for (size_t i = 0; i < new_ids.size(); i++) {
+      if (new_ids[i] == id) {
+        value = values[i].value;
+        replaced[i] = true;
+      }
+    }
+    fields.emplace_back(id, value);
+  });
+  for (size_t i = 0; i < values.size(); i++) {
+    if (!replaced[i]) {
+      fields.emplace_back(new_ids[i], values[i].value);
+    }
+  }
+  Write(fields, data);
+}
+
+} // ycsbc
@@ -0,0 +1,108 @@
+//
+//  row_codec.h
+//  YCSB-cpp
+//
+
+#ifndef YCSB_C_ROW_CODEC_H_
+#define YCSB_C_ROW_CODEC_H_
+
+#include "db.h"
+#include "utils/properties.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ycsbc {
+
+///
+/// Encoding of the fields of a record as a single value, used by the
+/// bindings that store one value per record.
+///
+/// A row is a flags byte, the varint number of fields, the varint index of
+/// each field if the row does not hold all fields in order, then either a
+/// table of uint32 end offsets followed by the values, which gives O(1)
+/// access to a field, or each value preceded by its varint length, which is
+/// smaller but has to be walked. Field names are not stored; a field is
+/// named by the workload field prefix and its index.
+///
+class RowCodec {
+ public:
+  RowCodec() : varint_lengths_(false) {}
+  ///
+  /// Codec of the fields configured by the workload properties.
+  ///
+  explicit RowCodec(const utils::Properties &props);
+
+  void Encode(const std::vector<DB::Field> &values, std::string &data) const;
+  ///
+  /// Appends the fields of a row to values, only the listed ones in the
+  /// listed order if fields is not null.
+  ///
+  void Decode(const char *p, const char *lim, const std::vector<std::string> *fields,
+              std::vector<DB::Field> &values) const;
+  void Decode(const std::string &data, const std::vector<std::string> *fields,
+              std::vector<DB::Field> &values) const {
+    Decode(data.data(), data.data() + data.size(), fields, values);
+  }
+  ///
+  /// Like Decode(), but the values point into the row data and the names
+  /// into the codec.
+  ///
+  void DecodeView(const char *p, const char *lim, const std::vector<std::string> *fields,
+                  std::vector<DB::FieldView> &values) const;
+  ///
+  /// Writes the row p..lim to data with the fields in values replaced or
+  /// added, without decoding the fields that are kept.
+  ///
+  void Update(const char *p, const char *lim, const std::vector<DB::Field> &values,
+              std::string &data) const;
+  void Update(const std::string &row, const std::vector<DB::Field> &values,
+              std::string &data) const {
+    Update(row.data(), row.data() + row.size(), values, data);
+  }
+
+ private:
+  enum Flags : uint8_t {
+    kVarintLengths = 1,
+    // field indexes are stored, the row is not all fields in order
+    kSparse = 2
+  };
+  // parsed header of a row
+  struct Layout {
+    uint8_t flags;
+    uint64_t count;
+    // varint field indexes if kSparse
+    const char *ids;
+    // end offsets, or the first length-prefixed value if kVarintLengths
+    const char *offsets;
+    const char *values;
+    const char *lim;
+  };
+  Layout Parse(const char *p, const char *lim) const;
+  ///
+  /// Finds the value of field id, in constant time for rows with fixed
+  /// offsets and all fields.
+  ///
+  bool Find(const Layout &row, size_t id, std::string_view *value) const;
+  template <typename F>
+  void ForEach(const Layout &row, F f) const;
+  ///
+  /// Appends a row of (field index, value) pairs, dense if they are all
+  /// fields in index order.
+  ///
+  void Write(const std::vector<std::pair<size_t, std::string_view>> &fields,
+             std::string &data) const;
+  size_t FieldId(std::string_view name) const;
+
+  std::string field_prefix_;
+  // field_prefix_ and the index of each field
+  std::vector<std::string> names_;
+  bool varint_lengths_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_ROW_CODEC_H_
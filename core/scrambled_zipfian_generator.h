@@ -11,6 +11,7 @@
 
 #include "generator.h"
 
+#include <algorithm>
 #include <cstdint>
 
 #include "zipfian_generator.h"
@@ -18,7 +19,7 @@
 
 namespace ycsbc {
 
-class ScrambledZipfianGenerator : public Generator<uint64_t> {
+class ScrambledZipfianGenerator : public RankedGenerator {
  public:
   ScrambledZipfianGenerator(uint64_t min, uint64_t max, double zipfian_const) :
       base_(min), num_items_(max - min + 1),
@@ -33,6 +34,7 @@ class ScrambledZipfianGenerator : public Generator<uint64_t> {
       ScrambledZipfianGenerator(0, num_items - 1) { }
 
   uint64_t Next();
+  uint64_t Next(double *rank);
   uint64_t Last();
 
  private:
@@ -54,6 +56,14 @@ inline uint64_t ScrambledZipfianGenerator::Next() {
   return Scramble(generator_.Next());
 }
 
+inline uint64_t ScrambledZipfianGenerator::Next(double *rank) {
+  // the zipfian value is the rank before scrambling; values past num_items_
+  // fold onto the key space and are counted among the least popular
+  uint64_t value = generator_.Next();
+  *rank = std::min(static_cast<double>(value) / num_items_, 1.0);
+  return Scramble(value);
+}
+
 inline uint64_t ScrambledZipfianGenerator::Last() {
   return Scramble(generator_.Last());
 }
@@ -0,0 +1,459 @@
+//
+//  sharded_db.cc
+//  YCSB-cpp
+//
+
+#include "sharded_db.h"
+#include "core_workload.h"
+#include "db_factory.h"
+#include "utils/utils.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <sstream>
+
+namespace {
+  const std::string PROP_DB = "sharded.db";
+  const std::string PROP_DB_DEFAULT = "basic";
+
+  const std::string PROP_COUNT = "sharded.count";
+  const std::string PROP_COUNT_DEFAULT = "4";
+
+  const std::string PROP_PARTITION = "sharded.partition";
+  const std::string PROP_PARTITION_DEFAULT = "hash";
+
+  const std::string PROP_BOUNDARIES = "sharded.boundaries";
+  const std::string PROP_BOUNDARIES_DEFAULT = "";
+
+  // property holding the data path of each binding, which is replaced by a
+  // directory per shard below it
+  const std::map<std::string, std::string> path_properties = {
+    {"leveldb", "leveldb.dbname"},
+    {"rocksdb", "rocksdb.dbname"},
+    {"lmdb", "lmdb.dbpath"},
+    {"wiredtiger", "wiredtiger.home"},
+    {"sqlite", "sqlite.dbpath"},
+  };
+
+  std::string PathProperty(const std::string &db_name) {
+    auto it = path_properties.find(db_name);
+    return it == path_properties.end() ? "" : it->second;
+  }
+
+  uint64_t HashKey(const std::string &key) {
+    uint64_t hash = ycsbc::utils::kFNVOffsetBasis64;
+    for (char c : key) {
+      hash = (hash ^ static_cast<unsigned char>(c)) * ycsbc::utils::kFNVPrime64;
+    }
+    return hash;
+  }
+} // anonymous
+
+namespace ycsbc {
+
+///
+/// Transaction with a transaction on each shard it was begun on, NULL for the
+/// other shards. The shards commit one after another, so the transaction is
+/// atomic only within each shard.
+///
+class ShardedDB::ShardedTransaction : public DB::Transaction {
+ public:
+  ShardedTransaction(ShardedDB *db, std::vector<Transaction *> txns)
+      : db_(db), txns_(std::move(txns)) {}
+  ~ShardedTransaction() {
+    for (Transaction *txn : txns_) {
+      delete txn;
+    }
+  }
+
+  Status Read(const std::string &table, const std::string &key,
+              const std::vector<std::string> *fields, std::vector<Field> &result) {
+    Transaction *txn = txns_[db_->ShardIndex(key)];
+    if (txn == nullptr) {
+      return kError;
+    }
+    return txn->Read(table, key, fields, result);
+  }
+
+  Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
+    Transaction *txn = txns_[db_->ShardIndex(key)];
+    if (txn == nullptr) {
+      return kError;
+    }
+    return txn->Update(table, key, values);
+  }
+
+  Status Commit() {
+    Status s = kOK;
+    size_t committed = 0;
+    for (Transaction *txn : txns_) {
+      if (txn == nullptr) {
+        continue;
+      }
+      // once a shard fails to commit, the remaining ones are rolled back
+      if (s == kOK) {
+        s = txn->Commit();
+        committed += s == kOK;
+      } else {
+        txn->Rollback();
+      }
+    }
+    partial_ = s != kOK && committed > 0;
+    // a retry would apply the updates of the committed shards twice
+    return partial_ ? kError : s;
+  }
+
+  bool PartiallyCommitted() const {
+    return partial_;
+  }
+
+  void Rollback() {
+    for (Transaction *txn : txns_) {
+      if (txn != nullptr) {
+        txn->Rollback();
+      }
+    }
+  }
+
+ private:
+  ShardedDB *db_;
+  std::vector<Transaction *> txns_;
+  bool partial_{false};
+};
+
+ShardedDB::~ShardedDB() {
+  for (DB *shard : shards_) {
+    delete shard;
+  }
+}
+
+void ShardedDB::Init() {
+  {
+    const std::lock_guard<std::mutex> lock(mu_);
+    if (shards_.empty()) {
+      const utils::Properties &props = *props_;
+      const std::string db_name = props.GetProperty(PROP_DB, PROP_DB_DEFAULT);
+      if (db_name == "sharded") {
+        throw utils::Exception("sharded binding cannot shard itself");
+      }
+      const int count = std::stoi(props.GetProperty(PROP_COUNT, PROP_COUNT_DEFAULT));
+      if (count <= 0) {
+        throw utils::Exception(PROP_COUNT + " must be positive");
+      }
+      const std::string partition = props.GetProperty(PROP_PARTITION, PROP_PARTITION_DEFAULT);
+      if (partition == "range") {
+        range_partitioned_ = true;
+      } else if (partition != "hash") {
+        throw utils::Exception("unknown sharded partition: " + partition);
+      }
+
+      shard_props_.assign(count, props);
+      const std::string path_prop = PathProperty(db_name);
+      if (!path_prop.empty()) {
+        const std::string path = props.GetProperty(path_prop);
+        if (path.empty()) {
+          throw utils::Exception(path_prop + " is missing");
+        }
+        // bindings create their own directory, but not its parents
+        std::filesystem::create_directories(path);
+        for (int i = 0; i < count; i++) {
+          shard_props_[i].SetProperty(path_prop, path + "/shard-" + std::to_string(i));
+        }
+      }
+      if (range_partitioned_) {
+        InitBoundaries(props);
+      }
+      for (int i = 0; i < count; i++) {
+        DB *shard = DBFactory::NewDB(db_name);
+        if (shard == nullptr) {
+          throw utils::Exception("unknown sharded db: " + db_name);
+        }
+        shard->SetProps(&shard_props_[i]);
+        shards_.push_back(shard);
+      }
+    }
+  }
+  for (DB *shard : shards_) {
+    shard->Init();
+  }
+}
+
+void ShardedDB::InitBoundaries(const utils::Properties &props) {
+  const size_t count = shard_props_.size();
+  const std::string list = props.GetProperty(PROP_BOUNDARIES, PROP_BOUNDARIES_DEFAULT);
+  boundaries_.clear();
+  if (!list.empty()) {
+    std::istringstream input(list);
+    std::string boundary;
+    while (std::getline(input, boundary, ',')) {
+      boundaries_.push_back(utils::Trim(boundary));
+    }
+    if (boundaries_.size() != count - 1) {
+      throw utils::Exception(PROP_BOUNDARIES + " must list " + std::to_string(count - 1) +
+                             " keys");
+    }
+    if (std::adjacent_find(boundaries_.begin(), boundaries_.end(),
+                           std::greater_equal<std::string>()) != boundaries_.end()) {
+      throw utils::Exception(PROP_BOUNDARIES + " must be in ascending order");
+    }
+    return;
+  }
+  // the loaded keys are only known for an ordered load, where they are
+  // split evenly by key number
+  if (props.GetProperty(CoreWorkload::INSERT_ORDER_PROPERTY,
+                        CoreWorkload::INSERT_ORDER_DEFAULT) != "ordered") {
+    throw utils::Exception(PROP_BOUNDARIES + " is required to range partition hashed keys");
+  }
+  const uint64_t start = std::stoull(props.GetProperty(CoreWorkload::INSERT_START_PROPERTY,
+                                                       CoreWorkload::INSERT_START_DEFAULT));
+  const uint64_t record_count = std::stoull(props.GetProperty(CoreWorkload::RECORD_COUNT_PROPERTY));
+  const int zero_padding = std::stoi(props.GetProperty(CoreWorkload::ZERO_PADDING_PROPERTY,
+                                                       CoreWorkload::ZERO_PADDING_DEFAULT));
+  for (size_t i = 1; i < count; i++) {
+    // same format as CoreWorkload::BuildKeyName()
+    std::string value = std::to_string(start + record_count * i / count);
+    int fill = std::max(0, zero_padding - static_cast<int>(value.size()));
+    boundaries_.push_back(std::string("user").append(fill, '0').append(value));
+  }
+  // without enough zero padding the key numbers do not sort like the keys
+  std::sort(boundaries_.begin(), boundaries_.end());
+  boundaries_.erase(std::unique(boundaries_.begin(), boundaries_.end()), boundaries_.end());
+}
+
+void ShardedDB::Cleanup() {
+  for (DB *shard : shards_) {
+    shard->Cleanup();
+  }
+}
+
+void ShardedDB::FinishLoad() {
+  for (DB *shard : shards_) {
+    shard->FinishLoad();
+  }
+}
+
+void ShardedDB::GetStats(std::vector<Field> &stats) {
+  const std::lock_guard<std::mutex> lock(mu_);
+  std::vector<Field> shard_stats;
+  for (size_t i = 0; i < shards_.size(); i++) {
+    shard_stats.clear();
+    shards_[i]->GetStats(shard_stats);
+    for (Field &field : shard_stats) {
+      stats.push_back({"shard" + std::to_string(i) + "." + field.name, std::move(field.value)});
+    }
+  }
+}
+
+std::string ShardedDB::GetDataPath() {
+  // called before Init(), so it only depends on the properties
+  const std::string path_prop = PathProperty(props_->GetProperty(PROP_DB, PROP_DB_DEFAULT));
+  return path_prop.empty() ? "" : props_->GetProperty(path_prop);
+}
+
+size_t ShardedDB::ShardIndex(const std::string &key) const {
+  if (range_partitioned_) {
+    return std::upper_bound(boundaries_.begin(), boundaries_.end(), key) - boundaries_.begin();
+  }
+  return HashKey(key) % shards_.size();
+}
+
+DB::Status ShardedDB::Scan(const std::string &table, const std::string &key, int len,
+                           const std::vector<std::string> *fields,
+                           std::vector<std::vector<Field>> &result) {
+  return ScanRange(table, key, len, ScanBounds(), fields,
+                   [&result](std::string_view, const std::vector<FieldView> &row) {
+    result.emplace_back();
+    for (const FieldView &field : row) {
+      result.back().push_back({std::string(field.name), std::string(field.value)});
+    }
+    return true;
+  });
+}
+
+DB::Status ShardedDB::ScanRange(const std::string &table, const std::string &key, int len,
+                                const ScanBounds &bounds, const std::vector<std::string> *fields,
+                                const ScanVisitor &visitor) {
+  if (shards_.size() == 1) {
+    return shards_[0]->ScanRange(table, key, len, bounds, fields, visitor);
+  }
+  if (range_partitioned_) {
+    return ScanRanges(table, key, len, bounds, fields, visitor);
+  }
+  return ScanMerged(table, key, len, bounds, fields, visitor);
+}
+
+DB::Status ShardedDB::ScanRanges(const std::string &table, const std::string &key, int len,
+                                 const ScanBounds &bounds, const std::vector<std::string> *fields,
+                                 const ScanVisitor &visitor) {
+  int remaining = len;
+  bool stopped = false;
+  const ScanVisitor counted = [&remaining, &stopped, &visitor](std::string_view row_key,
+                                                               const std::vector<FieldView> &row) {
+    remaining--;
+    stopped = !visitor(row_key, row);
+    return !stopped;
+  };
+  // each shard continues the scan where the previous one ran out of keys;
+  // the scan is not found only if every shard reported no records as such
+  size_t i = ShardIndex(key);
+  const std::string *start = &key;
+  Status result = kNotFound;
+  for (;;) {
+    Status s = shards_[i]->ScanRange(table, *start, remaining, bounds, fields, counted);
+    if (s == kOK) {
+      result = kOK;
+    } else if (s != kNotFound) {
+      return s;
+    }
+    if (stopped || remaining <= 0) {
+      break;
+    }
+    if (bounds.reverse) {
+      // all keys of the previous shard are below the first key of this one
+      if (i == 0 || (!bounds.end_key.empty() && bounds.end_key >= boundaries_[i - 1])) {
+        break;
+      }
+      start = &boundaries_[i - 1];
+      i--;
+    } else {
+      if (i == boundaries_.size() || (!bounds.end_key.empty() && bounds.end_key <= boundaries_[i])) {
+        break;
+      }
+      start = &boundaries_[i];
+      i++;
+    }
+  }
+  return result;
+}
+
+DB::Status ShardedDB::ScanMerged(const std::string &table, const std::string &key, int len,
+                                 const ScanBounds &bounds, const std::vector<std::string> *fields,
+                                 const ScanVisitor &visitor) {
+  // any shard may hold the next keys, so each one is scanned for all of them
+  scan_shards_.resize(shards_.size());
+  bool keyed = true;
+  // not found only if every shard reported no records as such
+  Status result = kNotFound;
+  for (size_t i = 0; i < shards_.size(); i++) {
+    ShardScan &scan = scan_shards_[i];
+    scan.pos = 0;
+    scan.end = 0;
+    Status s = shards_[i]->ScanRange(table, key, len, bounds, fields,
+                                     [&scan, &keyed](std::string_view row_key,
+                                                     const std::vector<FieldView> &row) {
+      if (row_key.empty()) {
+        keyed = false;
+        return false;
+      }
+      if (scan.end == scan.rows.size()) {
+        scan.rows.emplace_back();
+      }
+      ScanRow &copy = scan.rows[scan.end++];
+      copy.key.assign(row_key);
+      copy.fields.resize(row.size());
+      for (size_t j = 0; j < row.size(); j++) {
+        copy.fields[j].name.assign(row[j].name);
+        copy.fields[j].value.assign(row[j].value);
+      }
+      return true;
+    });
+    if (s == kOK) {
+      result = kOK;
+    } else if (s != kNotFound) {
+      return s;
+    }
+    if (!keyed) {
+      // records cannot be merged without their keys
+      return kNotImplemented;
+    }
+  }
+
+  // the shards are few, so the next record is picked by comparing the head
+  // of each of them
+  std::vector<FieldView> views;
+  for (int n = 0; n < len; n++) {
+    ShardScan *next = nullptr;
+    for (ShardScan &scan : scan_shards_) {
+      if (scan.pos == scan.end) {
+        continue;
+      }
+      const std::string &head = scan.rows[scan.pos].key;
+      if (next == nullptr ||
+          (bounds.reverse ? head > next->rows[next->pos].key : head < next->rows[next->pos].key)) {
+        next = &scan;
+      }
+    }
+    if (next == nullptr) {
+      break;
+    }
+    const ScanRow &row = next->rows[next->pos++];
+    views.clear();
+    for (const Field &field : row.fields) {
+      views.push_back({field.name, field.value});
+    }
+    if (!visitor(row.key, views)) {
+      break;
+    }
+  }
+  return result;
+}
+
+DB::Status ShardedDB::ExecuteTransaction(const std::string &table,
+                                         const std::vector<std::string> &read_keys,
+                                         const std::vector<std::string> *fields,
+                                         const std::vector<std::string> &write_keys,
+                                         std::vector<std::vector<Field>> &write_values,
+                                         int max_retries, TransactionHooks *hooks) {
+  // the keys are known up front, so each attempt only enters their shards
+  std::vector<bool> touched(shards_.size(), false);
+  for (const std::string &key : read_keys) {
+    touched[ShardIndex(key)] = true;
+  }
+  for (const std::string &key : write_keys) {
+    touched[ShardIndex(key)] = true;
+  }
+  txn_shards_.clear();
+  for (size_t i = 0; i < touched.size(); i++) {
+    if (touched[i]) {
+      txn_shards_.push_back(i);
+    }
+  }
+  Status s = DB::ExecuteTransaction(table, read_keys, fields, write_keys, write_values,
+                                    max_retries, hooks);
+  txn_shards_.clear();
+  return s;
+}
+
+DB::Status ShardedDB::BeginTransaction(Transaction **txn) {
+  // bindings may lock at begin, so the shards are always entered in ascending
+  // order: the ones of the keys of ExecuteTransaction(), or else all of them
+  std::vector<Transaction *> txns(shards_.size(), nullptr);
+  for (size_t i = 0; i < shards_.size(); i++) {
+    if (!txn_shards_.empty() &&
+        !std::binary_search(txn_shards_.begin(), txn_shards_.end(), i)) {
+      continue;
+    }
+    Status s = shards_[i]->BeginTransaction(&txns[i]);
+    if (s != kOK) {
+      txns[i] = nullptr;
+      for (Transaction *begun : txns) {
+        if (begun != nullptr) {
+          begun->Rollback();
+          delete begun;
+        }
+      }
+      return s;
+    }
+  }
+  *txn = new ShardedTransaction(this, std::move(txns));
+  return kOK;
+}
+
+DB *NewShardedDB() {
+  return new ShardedDB;
+}
+
+const bool registered = DBFactory::RegisterDB("sharded", NewShardedDB);
+
+} // ycsbc
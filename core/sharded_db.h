@@ -0,0 +1,127 @@
+//
+//  sharded_db.h
+//  YCSB-cpp
+//
+
+#ifndef YCSB_C_SHARDED_DB_H_
+#define YCSB_C_SHARDED_DB_H_
+
+#include "db.h"
+#include "utils/properties.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ycsbc {
+
+///
+/// Binding that partitions the keys across several instances of another
+/// binding, each with its own data directory below the configured path.
+/// Keys are assigned by a hash of the key or by ranges between boundary
+/// keys. Point operations go to the shard of the key. Scans go through the
+/// shards in key order when range partitioned, and read every shard and
+/// merge the records by key when hash partitioned.
+///
+class ShardedDB : public DB {
+ public:
+  ~ShardedDB();
+
+  void Init();
+  void Cleanup();
+  void FinishLoad();
+  void GetStats(std::vector<Field> &stats);
+  std::string GetDataPath();
+
+  Status Read(const std::string &table, const std::string &key,
+              const std::vector<std::string> *fields, std::vector<Field> &result) {
+    return ShardOf(key)->Read(table, key, fields, result);
+  }
+  Status ReadView(const std::string &table, const std::string &key,
+                  const std::vector<std::string> *fields, const RowVisitor &visitor) {
+    return ShardOf(key)->ReadView(table, key, fields, visitor);
+  }
+  Status Scan(const std::string &table, const std::string &key, int len,
+              const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result);
+  Status ScanView(const std::string &table, const std::string &key, int len,
+                  const std::vector<std::string> *fields, const ScanVisitor &visitor) {
+    return ScanRange(table, key, len, ScanBounds(), fields, visitor);
+  }
+  Status ScanRange(const std::string &table, const std::string &key, int len,
+                   const ScanBounds &bounds, const std::vector<std::string> *fields,
+                   const ScanVisitor &visitor);
+  Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
+    return ShardOf(key)->Update(table, key, values);
+  }
+  Status ReadModifyWrite(const std::string &table, const std::string &key,
+                         const std::vector<std::string> *fields, const RowVisitor &visitor,
+                         std::vector<Field> &values) {
+    return ShardOf(key)->ReadModifyWrite(table, key, fields, visitor, values);
+  }
+  Status Insert(const std::string &table, const std::string &key, std::vector<Field> &values) {
+    return ShardOf(key)->Insert(table, key, values);
+  }
+  Status Delete(const std::string &table, const std::string &key) {
+    return ShardOf(key)->Delete(table, key);
+  }
+
+  Status BeginTransaction(Transaction **txn);
+  Status ExecuteTransaction(const std::string &table, const std::vector<std::string> &read_keys,
+                            const std::vector<std::string> *fields,
+                            const std::vector<std::string> &write_keys,
+                            std::vector<std::vector<Field>> &write_values,
+                            int max_retries, TransactionHooks *hooks = nullptr);
+
+ private:
+  class ShardedTransaction;
+
+  // record of a shard buffered by a hash partitioned scan
+  struct ScanRow {
+    std::string key;
+    std::vector<Field> fields;
+  };
+  // records of a shard in the current scan, rows before end are valid and
+  // the ones before pos are merged
+  struct ShardScan {
+    std::vector<ScanRow> rows;
+    size_t end = 0;
+    size_t pos = 0;
+  };
+
+  size_t ShardIndex(const std::string &key) const;
+  DB *ShardOf(const std::string &key) {
+    return shards_[ShardIndex(key)];
+  }
+  ///
+  /// Sets the boundaries for range partitioning, from the property or else
+  /// evenly over the keys of an ordered load.
+  ///
+  void InitBoundaries(const utils::Properties &props);
+
+  Status ScanRanges(const std::string &table, const std::string &key, int len,
+                    const ScanBounds &bounds, const std::vector<std::string> *fields,
+                    const ScanVisitor &visitor);
+  Status ScanMerged(const std::string &table, const std::string &key, int len,
+                    const ScanBounds &bounds, const std::vector<std::string> *fields,
+                    const ScanVisitor &visitor);
+
+  std::vector<DB *> shards_;
+  // copies of the properties with the data path of each shard
+  std::vector<utils::Properties> shard_props_;
+  bool range_partitioned_{false};
+  // first key of each shard but the first one, when range partitioned
+  std::vector<std::string> boundaries_;
+  // kept between hash partitioned scans to reuse the buffers of the records
+  std::vector<ShardScan> scan_shards_;
+  // ascending indexes of the shards touched by the running
+  // ExecuteTransaction(), empty to begin transactions on every shard
+  std::vector<size_t> txn_shards_;
+  // guards shards_ against the status thread while they are created
+  std::mutex mu_;
+};
+
+DB *NewShardedDB();
+
+} // ycsbc
+
+#endif // YCSB_C_SHARDED_DB_H_
@@ -18,7 +18,7 @@
 
 namespace ycsbc {
 
-class SkewedLatestGenerator : public Generator<uint64_t> {
+class SkewedLatestGenerator : public RankedGenerator {
  public:
   SkewedLatestGenerator(CounterGenerator &counter) :
       basis_(counter), zipfian_(basis_.Last()) {
@@ -26,6 +26,7 @@ class SkewedLatestGenerator : public Generator<uint64_t> {
   }
   
   uint64_t Next();
+  uint64_t Next(double *rank);
   uint64_t Last() { return last_; }
  private:
   CounterGenerator &basis_;
@@ -38,6 +39,14 @@ inline uint64_t SkewedLatestGenerator::Next() {
   return last_ = max - zipfian_.Next(max);
 }
 
+inline uint64_t SkewedLatestGenerator::Next(double *rank) {
+  uint64_t max = basis_.Last();
+  uint64_t age = zipfian_.Next(max);
+  // the most recent key is the most popular
+  *rank = static_cast<double>(age) / (max + 1);
+  return last_ = max - age;
+}
+
 } // ycsbc
 
 #endif // YCSB_C_SKEWED_LATEST_GENERATOR_H_
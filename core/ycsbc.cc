@@ -9,6 +9,7 @@
 #include <cstring>
 #include <ctime>
 
+#include <memory>
 #include <string>
 #include <iostream>
 #include <vector>
@@ -17,12 +18,17 @@
 #include <chrono>
 #include <iomanip>
 
+#include "cache_db.h"
 #include "client.h"
 #include "core_workload.h"
 #include "db_factory.h"
 #include "measurements.h"
+#include "metrics_server.h"
+#include "report.h"
 #include "utils/countdown_latch.h"
+#include "utils/perf_counters.h"
 #include "utils/rate_limit.h"
+#include "utils/resource_usage.h"
 #include "utils/timer.h"
 #include "utils/utils.h"
 
@@ -30,9 +36,11 @@ void UsageMessage(const char *command);
 bool StrStartWith(const char *str, const char *pre);
 void ParseCommandLine(int argc, const char *argv[], ycsbc::utils::Properties &props);
 
-void StatusThread(ycsbc::Measurements *measurements, ycsbc::utils::CountDownLatch *latch, int interval) {
+void StatusThread(ycsbc::Measurements *measurements, ycsbc::DB *db, bool resources,
+                  ycsbc::utils::CountDownLatch *latch, int interval) {
   using namespace std::chrono;
   time_point<system_clock> start = system_clock::now();
+  ycsbc::utils::ResourceUsage last_usage = ycsbc::utils::ResourceUsage::Sample();
   bool done = false;
   while (1) {
     time_point<system_clock> now = system_clock::now();
@@ -42,7 +50,22 @@ void StatusThread(ycsbc::Measurements *measurements, ycsbc::utils::CountDownLatc
     std::cout << std::put_time(std::localtime(&now_c), "%F %T") << ' '
               << static_cast<long long>(elapsed_time.count()) << " sec: ";
 
-    std::cout << measurements->GetStatusMsg() << std::endl;
+    std::cout << measurements->GetStatusMsg();
+    if (resources) {
+      ycsbc::utils::ResourceUsage usage = ycsbc::utils::ResourceUsage::Sample();
+      std::cout << ' ' << ycsbc::ResourceStatusMsg(usage.Since(last_usage),
+                                                   measurements->interval_operations());
+      last_usage = usage;
+    }
+    std::cout << std::endl;
+
+    if (db) {
+      std::vector<ycsbc::DB::Field> stats;
+      db->GetStats(stats);
+      for (const ycsbc::DB::Field &stat : stats) {
+        std::cout << "  " << stat.name << ": " << stat.value << std::endl;
+      }
+    }
 
     if (done) {
       break;
@@ -97,12 +120,33 @@ int main(const int argc, const char *argv[]) {
 
   const int num_threads = stoi(props.GetProperty("threadcount", "1"));
 
+  const std::string timer_type = props.GetProperty("timer", "steady");
+  if (timer_type == "tsc") {
+    if (!ycsbc::utils::LatencyTimer::EnableTsc()) {
+      std::cerr << "Invariant TSC is not available, using steady_clock" << std::endl;
+    }
+  } else if (timer_type != "steady") {
+    std::cerr << "Unknown timer " << timer_type << std::endl;
+    exit(1);
+  }
+  if (props.GetProperty("timer.selftest", "false") == "true") {
+    ycsbc::utils::LatencyTimer::SelfTest(std::cout);
+  }
+
   ycsbc::Measurements *measurements = ycsbc::CreateMeasurements(&props);
   if (measurements == nullptr) {
     std::cerr << "Unknown measurements name" << std::endl;
     exit(1);
   }
 
+  if (measurements->perf_counters()) {
+    ycsbc::utils::PerfCounters probe(measurements->perf_kernel());
+    if (!probe.HardwareAvailable()) {
+      std::cerr << "Hardware performance counters are not available, "
+                   "reporting software counters only" << std::endl;
+    }
+  }
+
   std::vector<ycsbc::DB *> dbs;
   for (int i = 0; i < num_threads; i++) {
     ycsbc::DB *db = ycsbc::DBFactory::CreateDB(&props, measurements);
@@ -115,10 +159,27 @@ int main(const int argc, const char *argv[]) {
 
   ycsbc::CoreWorkload wl;
   wl.Init(props);
+  wl.set_measurements(measurements);
+
+  std::vector<ycsbc::PhaseReport> reports;
+  // logical size of the records inserted by all phases so far
+  uint64_t logical_size = 0;
+  const std::string data_path = dbs[0]->GetDataPath();
 
   // print status periodically
   const bool show_status = (props.GetProperty("status", "false") == "true");
   const int status_interval = std::stoi(props.GetProperty("status.interval", "10"));
+  // engine statistics are polled through the DB instance of the first client thread
+  ycsbc::DB *stats_db = props.GetProperty("status.dbstats", "false") == "true" ? dbs[0] : nullptr;
+  const bool show_resources = (props.GetProperty("status.resources", "false") == "true");
+
+  // live measurements for scraping, stopped when main returns
+  std::unique_ptr<ycsbc::MetricsServer> metrics_server;
+  const int metrics_port = std::stoi(props.GetProperty("metrics.port", "0"));
+  if (metrics_port > 0) {
+    metrics_server.reset(new ycsbc::MetricsServer(
+        measurements, props.GetProperty("metrics.address", "127.0.0.1"), metrics_port));
+  }
 
   // load phase
   if (do_load) {
@@ -128,12 +189,18 @@ int main(const int argc, const char *argv[]) {
     ycsbc::utils::Timer<double> timer;
 
     timer.Start();
+    if (metrics_server) {
+      metrics_server->StartPhase("load");
+    }
+    ycsbc::utils::ResourceUsage usage_start = ycsbc::utils::ResourceUsage::Sample();
     std::future<void> status_future;
     if (show_status) {
       status_future = std::async(std::launch::async, StatusThread,
-                                 measurements, &latch, status_interval);
+                                 measurements, stats_db, show_resources, &latch, status_interval);
     }
     std::vector<std::future<int>> client_threads;
+    // first key of each thread's range when inserts are partitioned
+    uint64_t key_start = wl.insert_start();
     for (int i = 0; i < num_threads; ++i) {
       int thread_ops = total_ops / num_threads;
       if (i < total_ops % num_threads) {
@@ -141,7 +208,9 @@ int main(const int argc, const char *argv[]) {
       }
 
       client_threads.emplace_back(std::async(std::launch::async, ycsbc::ClientThread, dbs[i], &wl,
-                                             thread_ops, true, true, !do_transaction, &latch, nullptr));
+                                             thread_ops, key_start, true, true, !do_transaction,
+                                             &latch, nullptr, measurements));
+      key_start += thread_ops;
     }
     assert((int)client_threads.size() == num_threads);
 
@@ -151,6 +220,7 @@ int main(const int argc, const char *argv[]) {
       sum += n.get();
     }
     double runtime = timer.End();
+    ycsbc::utils::ResourceUsage usage = ycsbc::utils::ResourceUsage::Sample().Since(usage_start);
 
     if (show_status) {
       status_future.wait();
@@ -159,6 +229,14 @@ int main(const int argc, const char *argv[]) {
     std::cout << "Load runtime(sec): " << runtime << std::endl;
     std::cout << "Load operations(ops): " << sum << std::endl;
     std::cout << "Load throughput(ops/sec): " << sum / runtime << std::endl;
+    std::vector<uint64_t> bytes = measurements->GetBytes();
+    logical_size += bytes[ycsbc::BYTES_INSERTED];
+    reports.push_back({"load", runtime, static_cast<uint64_t>(sum), measurements->GetSummary(),
+                       measurements->GetBreakdown(), usage, bytes, logical_size,
+                       ycsbc::utils::DiskUsage(data_path), measurements->GetPerf(),
+                       measurements->GetSlowOperations(), measurements->GetKeyBuckets(),
+                       measurements->GetSizes(), ycsbc::CacheDB::TakePhaseSummary()});
+    ycsbc::PrintReport(std::cout, reports.back());
   }
 
   measurements->Reset();
@@ -178,10 +256,14 @@ int main(const int argc, const char *argv[]) {
     ycsbc::utils::Timer<double> timer;
 
     timer.Start();
+    if (metrics_server) {
+      metrics_server->StartPhase("run");
+    }
+    ycsbc::utils::ResourceUsage usage_start = ycsbc::utils::ResourceUsage::Sample();
     std::future<void> status_future;
     if (show_status) {
       status_future = std::async(std::launch::async, StatusThread,
-                                 measurements, &latch, status_interval);
+                                 measurements, stats_db, show_resources, &latch, status_interval);
     }
     std::vector<std::future<int>> client_threads;
     std::vector<ycsbc::utils::RateLimiter *> rate_limiters;
@@ -197,7 +279,8 @@ int main(const int argc, const char *argv[]) {
       }
       rate_limiters.push_back(rlim);
       client_threads.emplace_back(std::async(std::launch::async, ycsbc::ClientThread, dbs[i], &wl,
-                                             thread_ops, false, !do_load, true, &latch, rlim));
+                                             thread_ops, 0, false, !do_load, true, &latch, rlim,
+                                             measurements));
     }
 
     std::future<void> rlim_future;
@@ -213,6 +296,7 @@ int main(const int argc, const char *argv[]) {
       sum += n.get();
     }
     double runtime = timer.End();
+    ycsbc::utils::ResourceUsage usage = ycsbc::utils::ResourceUsage::Sample().Since(usage_start);
 
     if (show_status) {
       status_future.wait();
@@ -221,6 +305,23 @@ int main(const int argc, const char *argv[]) {
     std::cout << "Run runtime(sec): " << runtime << std::endl;
     std::cout << "Run operations(ops): " << sum << std::endl;
     std::cout << "Run throughput(ops/sec): " << sum / runtime << std::endl;
+    std::vector<uint64_t> bytes = measurements->GetBytes();
+    logical_size += bytes[ycsbc::BYTES_INSERTED];
+    reports.push_back({"run", runtime, static_cast<uint64_t>(sum), measurements->GetSummary(),
+                       measurements->GetBreakdown(), usage, bytes, logical_size,
+                       ycsbc::utils::DiskUsage(data_path), measurements->GetPerf(),
+                       measurements->GetSlowOperations(), measurements->GetKeyBuckets(),
+                       measurements->GetSizes(), ycsbc::CacheDB::TakePhaseSummary()});
+    ycsbc::PrintReport(std::cout, reports.back());
+  }
+
+  const std::string json_file = props.GetProperty("export.json", "");
+  if (json_file != "") {
+    ycsbc::ExportJson(json_file, props, reports);
+  }
+  const std::string csv_file = props.GetProperty("export.csv", "");
+  if (csv_file != "") {
+    ycsbc::ExportCsv(csv_file, props, reports);
   }
 
   for (int i = 0; i < num_threads; i++) {
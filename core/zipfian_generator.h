@@ -88,7 +88,7 @@ inline uint64_t ZipfianGenerator::Next(uint64_t num) {
   assert(num >= 2 && num < kMaxNumItems);
   if (num != count_for_zeta_) {
     // recompute zeta and eta
-    std::lock_guard<std::mutex> lock(mutex_);
+    GeneratorLock lock(mutex_);
     if (num > count_for_zeta_) {
       zeta_n_ = Zeta(count_for_zeta_, num, theta_, zeta_n_);
       count_for_zeta_ = num;
@@ -51,8 +51,7 @@ namespace {
 
 namespace ycsbc {
 
-leveldb::DB *LeveldbDB::db_ = nullptr;
-int LeveldbDB::ref_cnt_ = 0;
+std::map<std::string, LeveldbDB::OpenDB> LeveldbDB::open_dbs_;
 std::mutex LeveldbDB::mu_;
 
 void LeveldbDB::Init() {
@@ -63,22 +62,34 @@ void LeveldbDB::Init() {
   if (format == "single") {
     format_ = kSingleEntry;
     method_read_ = &LeveldbDB::ReadSingleEntry;
+    method_read_view_ = &LeveldbDB::ReadViewSingleEntry;
     method_scan_ = &LeveldbDB::ScanSingleEntry;
+    method_scan_view_ = &LeveldbDB::ScanViewSingleEntry;
+    method_scan_range_ = &LeveldbDB::ScanRangeSingleEntry;
     method_update_ = &LeveldbDB::UpdateSingleEntry;
+    method_read_modify_write_ = &LeveldbDB::ReadModifyWriteSingleEntry;
     method_insert_ = &LeveldbDB::InsertSingleEntry;
     method_delete_ = &LeveldbDB::DeleteSingleEntry;
   } else if (format == "row") {
     format_ = kRowMajor;
     method_read_ = &LeveldbDB::ReadCompKeyRM;
+    method_read_view_ = &LeveldbDB::ReadViewCompKey;
     method_scan_ = &LeveldbDB::ScanCompKeyRM;
+    method_scan_view_ = &LeveldbDB::ScanViewCompKey;
+    method_scan_range_ = &LeveldbDB::ScanRangeCompKey;
     method_update_ = &LeveldbDB::InsertCompKey;
+    method_read_modify_write_ = &LeveldbDB::ReadModifyWriteCompKey;
     method_insert_ = &LeveldbDB::InsertCompKey;
     method_delete_ = &LeveldbDB::DeleteCompKey;
   } else if (format == "column") {
     format_ = kColumnMajor;
     method_read_ = &LeveldbDB::ReadCompKeyCM;
+    method_read_view_ = &LeveldbDB::ReadViewCompKey;
     method_scan_ = &LeveldbDB::ScanCompKeyCM;
+    method_scan_view_ = &LeveldbDB::ScanViewCompKey;
+    method_scan_range_ = &LeveldbDB::ScanRangeCompKey;
     method_update_ = &LeveldbDB::InsertCompKey;
+    method_read_modify_write_ = &LeveldbDB::ReadModifyWriteCompKey;
     method_insert_ = &LeveldbDB::InsertCompKey;
     method_delete_ = &LeveldbDB::DeleteCompKey;
   } else {
@@ -88,16 +99,19 @@ void LeveldbDB::Init() {
                                             CoreWorkload::FIELD_COUNT_DEFAULT));
   field_prefix_ = props.GetProperty(CoreWorkload::FIELD_NAME_PREFIX,
                                     CoreWorkload::FIELD_NAME_PREFIX_DEFAULT);
-
-  ref_cnt_++;
-  if (db_) {
-    return;
-  }
+  codec_ = RowCodec(props);
 
   const std::string &db_path = props.GetProperty(PROP_NAME, PROP_NAME_DEFAULT);
   if (db_path == "") {
     throw utils::Exception("LevelDB db path is missing");
   }
+  db_path_ = db_path;
+  OpenDB &open_db = open_dbs_[db_path];
+  open_db.ref_cnt++;
+  if (open_db.db) {
+    db_ = open_db.db;
+    return;
+  }
 
   leveldb::Options opt;
   opt.create_if_missing = true;
@@ -111,18 +125,41 @@ void LeveldbDB::Init() {
       throw utils::Exception(std::string("LevelDB DestroyDB: ") + s.ToString());
     }
   }
-  s = leveldb::DB::Open(opt, db_path, &db_);
+  s = leveldb::DB::Open(opt, db_path, &open_db.db);
   if (!s.ok()) {
     throw utils::Exception(std::string("LevelDB Open: ") + s.ToString());
   }
+  db_ = open_db.db;
 }
 
 void LeveldbDB::Cleanup() {
   const std::lock_guard<std::mutex> lock(mu_);
-  if (--ref_cnt_) {
+  db_ = nullptr;
+  OpenDB &open_db = open_dbs_[db_path_];
+  if (--open_db.ref_cnt) {
     return;
   }
-  delete db_;
+  delete open_db.db;
+  open_dbs_.erase(db_path_);
+}
+
+void LeveldbDB::GetStats(std::vector<Field> &stats) {
+  const std::lock_guard<std::mutex> lock(mu_);
+  if (db_ == nullptr) {
+    return;
+  }
+  // leveldb.stats is a multi-line table of per-level sizes and compaction io
+  const std::string props[] = {"leveldb.approximate-memory-usage", "leveldb.stats"};
+  for (const std::string &name : props) {
+    std::string value;
+    if (db_->GetProperty(name, &value)) {
+      stats.push_back({name, value});
+    }
+  }
+}
+
+std::string LeveldbDB::GetDataPath() {
+  return props_->GetProperty(PROP_NAME, PROP_NAME_DEFAULT);
 }
 
 void LeveldbDB::GetOptions(const utils::Properties &props, leveldb::Options *opt) {
@@ -170,59 +207,6 @@ void LeveldbDB::GetOptions(const utils::Properties &props, leveldb::Options *opt
   }
 }
 
-void LeveldbDB::SerializeRow(const std::vector<Field> &values, std::string *data) {
-  for (const Field &field : values) {
-    uint32_t len = field.name.size();
-    data->append(reinterpret_cast<char *>(&len), sizeof(uint32_t));
-    data->append(field.name.data(), field.name.size());
-    len = field.value.size();
-    data->append(reinterpret_cast<char *>(&len), sizeof(uint32_t));
-    data->append(field.value.data(), field.value.size());
-  }
-}
-
-void LeveldbDB::DeserializeRowFilter(std::vector<Field> *values, const std::string &data,
-                                     const std::vector<std::string> &fields) {
-  const char *p = data.data();
-  const char *lim = p + data.size();
-
-  std::vector<std::string>::const_iterator filter_iter = fields.begin();
-  while (p != lim && filter_iter != fields.end()) {
-    assert(p < lim);
-    uint32_t len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string field(p, static_cast<const size_t>(len));
-    p += len;
-    len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string value(p, static_cast<const size_t>(len));
-    p += len;
-    if (*filter_iter == field) {
-      values->push_back({field, value});
-      filter_iter++;
-    }
-  }
-  assert(values->size() == fields.size());
-}
-
-void LeveldbDB::DeserializeRow(std::vector<Field> *values, const std::string &data) {
-  const char *p = data.data();
-  const char *lim = p + data.size();
-  while (p != lim) {
-    assert(p < lim);
-    uint32_t len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string field(p, static_cast<const size_t>(len));
-    p += len;
-    len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string value(p, static_cast<const size_t>(len));
-    p += len;
-    values->push_back({field, value});
-  }
-  assert(values->size() == fieldcount_);
-}
-
 std::string LeveldbDB::BuildCompKey(const std::string &key, const std::string &field_name) {
   switch (format_) {
     case kRowMajor:
@@ -258,11 +242,23 @@ DB::Status LeveldbDB::ReadSingleEntry(const std::string &table, const std::strin
   } else if (!s.ok()) {
     throw utils::Exception(std::string("LevelDB Get: ") + s.ToString());
   }
-  if (fields != nullptr) {
-    DeserializeRowFilter(&result, data, *fields);
-  } else {
-    DeserializeRow(&result, data);
+  codec_.Decode(data, fields, result);
+  return kOK;
+}
+
+DB::Status LeveldbDB::ReadViewSingleEntry(const std::string &table, const std::string &key,
+                                          const std::vector<std::string> *fields,
+                                          const RowVisitor &visitor) {
+  leveldb::Status s = db_->Get(leveldb::ReadOptions(), key, &read_buffer_);
+  if (s.IsNotFound()) {
+    return kNotFound;
+  } else if (!s.ok()) {
+    throw utils::Exception(std::string("LevelDB Get: ") + s.ToString());
   }
+  std::vector<FieldView> values;
+  codec_.DecodeView(read_buffer_.data(), read_buffer_.data() + read_buffer_.size(), fields,
+                    values);
+  visitor(values);
   return kOK;
 }
 
@@ -272,15 +268,56 @@ DB::Status LeveldbDB::ScanSingleEntry(const std::string &table, const std::strin
   leveldb::Iterator *db_iter = db_->NewIterator(leveldb::ReadOptions());
   db_iter->Seek(key);
   for (int i = 0; db_iter->Valid() && i < len; i++) {
-    std::string data = db_iter->value().ToString();
+    leveldb::Slice data = db_iter->value();
     result.push_back(std::vector<Field>());
-    std::vector<Field> &values = result.back();
-    if (fields != nullptr) {
-      DeserializeRowFilter(&values, data, *fields);
+    codec_.Decode(data.data(), data.data() + data.size(), fields, result.back());
+    db_iter->Next();
+  }
+  delete db_iter;
+  return kOK;
+}
+
+DB::Status LeveldbDB::ScanViewSingleEntry(const std::string &table, const std::string &key,
+                                          int len, const std::vector<std::string> *fields,
+                                          const ScanVisitor &visitor) {
+  return ScanRangeSingleEntry(table, key, len, ScanBounds(), fields, visitor);
+}
+
+DB::Status LeveldbDB::ScanRangeSingleEntry(const std::string &table, const std::string &key,
+                                           int len, const ScanBounds &bounds,
+                                           const std::vector<std::string> *fields,
+                                           const ScanVisitor &visitor) {
+  leveldb::Iterator *db_iter = db_->NewIterator(leveldb::ReadOptions());
+  const leveldb::Slice end_key(bounds.end_key);
+  std::vector<FieldView> values;
+  db_iter->Seek(key);
+  if (bounds.reverse) {
+    // Seek() finds the first key at or after the start key
+    if (!db_iter->Valid()) {
+      db_iter->SeekToLast();
+    } else if (db_iter->key().compare(key) != 0) {
+      db_iter->Prev();
+    }
+  }
+  for (int i = 0; db_iter->Valid() && i < len; i++) {
+    if (!bounds.end_key.empty()) {
+      int c = db_iter->key().compare(end_key);
+      if (bounds.reverse ? c <= 0 : c >= 0) {
+        break;
+      }
+    }
+    // the value stays valid until the iterator moves
+    leveldb::Slice data = db_iter->value();
+    values.clear();
+    codec_.DecodeView(data.data(), data.data() + data.size(), fields, values);
+    if (!visitor(std::string_view(db_iter->key().data(), db_iter->key().size()), values)) {
+      break;
+    }
+    if (bounds.reverse) {
+      db_iter->Prev();
     } else {
-      DeserializeRow(&values, data);
+      db_iter->Next();
     }
-    db_iter->Next();
   }
   delete db_iter;
   return kOK;
@@ -295,24 +332,35 @@ DB::Status LeveldbDB::UpdateSingleEntry(const std::string &table, const std::str
   } else if (!s.ok()) {
     throw utils::Exception(std::string("LevelDB Get: ") + s.ToString());
   }
-  std::vector<Field> current_values;
-  DeserializeRow(&current_values, data);
-  for (Field &new_field : values) {
-    bool found MAYBE_UNUSED = false;
-    for (Field &cur_field : current_values) {
-      if (cur_field.name == new_field.name) {
-        found = true;
-        cur_field.value = new_field.value;
-        break;
-      }
-    }
-    assert(found);
-  }
+  std::string new_data;
+  codec_.Update(data, values, new_data);
   leveldb::WriteOptions wopt;
+  s = db_->Put(wopt, key, new_data);
+  if (!s.ok()) {
+    throw utils::Exception(std::string("LevelDB Put: ") + s.ToString());
+  }
+  return kOK;
+}
 
-  data.clear();
-  SerializeRow(current_values, &data);
-  s = db_->Put(wopt, key, data);
+DB::Status LeveldbDB::ReadModifyWriteSingleEntry(const std::string &table,
+                                                 const std::string &key,
+                                                 const std::vector<std::string> *fields,
+                                                 const RowVisitor &visitor,
+                                                 std::vector<Field> &values) {
+  std::string data;
+  leveldb::Status s = db_->Get(leveldb::ReadOptions(), key, &data);
+  if (s.IsNotFound()) {
+    return kNotFound;
+  } else if (!s.ok()) {
+    throw utils::Exception(std::string("LevelDB Get: ") + s.ToString());
+  }
+  std::vector<FieldView> current_values;
+  codec_.DecodeView(data.data(), data.data() + data.size(), fields, current_values);
+  visitor(current_values);
+  std::string new_data;
+  codec_.Update(data, values, new_data);
+  leveldb::WriteOptions wopt;
+  s = db_->Put(wopt, key, new_data);
   if (!s.ok()) {
     throw utils::Exception(std::string("LevelDB Put: ") + s.ToString());
   }
@@ -322,7 +370,7 @@ DB::Status LeveldbDB::UpdateSingleEntry(const std::string &table, const std::str
 DB::Status LeveldbDB::InsertSingleEntry(const std::string &table, const std::string &key,
                                         std::vector<Field> &values) {
   std::string data;
-  SerializeRow(values, &data);
+  codec_.Encode(values, data);
   leveldb::WriteOptions wopt;
   leveldb::Status s = db_->Put(wopt, key, data);
   if (!s.ok()) {
@@ -456,6 +504,35 @@ DB::Status LeveldbDB::InsertCompKey(const std::string &table, const std::string
   return kOK;
 }
 
+DB::Status LeveldbDB::ReadViewCompKey(const std::string &table, const std::string &key,
+                                      const std::vector<std::string> *fields,
+                                      const RowVisitor &visitor) {
+  // a record spans several entries, so the record is collected first
+  return DB::ReadView(table, key, fields, visitor);
+}
+
+DB::Status LeveldbDB::ScanViewCompKey(const std::string &table, const std::string &key, int len,
+                                      const std::vector<std::string> *fields,
+                                      const ScanVisitor &visitor) {
+  // a record spans several entries, so the records are collected first
+  return DB::ScanView(table, key, len, fields, visitor);
+}
+
+DB::Status LeveldbDB::ScanRangeCompKey(const std::string &table, const std::string &key, int len,
+                                       const ScanBounds &bounds,
+                                       const std::vector<std::string> *fields,
+                                       const ScanVisitor &visitor) {
+  return DB::ScanRange(table, key, len, bounds, fields, visitor);
+}
+
+DB::Status LeveldbDB::ReadModifyWriteCompKey(const std::string &table, const std::string &key,
+                                             const std::vector<std::string> *fields,
+                                             const RowVisitor &visitor,
+                                             std::vector<Field> &values) {
+  // fields are written without reading the record, so it is read separately
+  return DB::ReadModifyWrite(table, key, fields, visitor, values);
+}
+
 DB::Status LeveldbDB::DeleteCompKey(const std::string &table, const std::string &key) {
   leveldb::WriteOptions wopt;
   leveldb::WriteBatch batch;
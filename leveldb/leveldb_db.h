@@ -9,10 +9,12 @@
 #define YCSB_C_LEVELDB_DB_H_
 
 #include <iostream>
+#include <map>
 #include <string>
 #include <mutex>
 
 #include "core/db.h"
+#include "core/row_codec.h"
 #include "utils/properties.h"
 
 #include <leveldb/db.h>
@@ -32,20 +34,46 @@ class LeveldbDB : public DB {
 
   void Cleanup();
 
+  void GetStats(std::vector<Field> &stats);
+
+  std::string GetDataPath();
+
   Status Read(const std::string &table, const std::string &key,
               const std::vector<std::string> *fields, std::vector<Field> &result) {
     return (this->*(method_read_))(table, key, fields, result);
   }
 
+  Status ReadView(const std::string &table, const std::string &key,
+                  const std::vector<std::string> *fields, const RowVisitor &visitor) {
+    return (this->*(method_read_view_))(table, key, fields, visitor);
+  }
+
   Status Scan(const std::string &table, const std::string &key, int len,
               const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result) {
     return (this->*(method_scan_))(table, key, len, fields, result);
   }
 
+  Status ScanView(const std::string &table, const std::string &key, int len,
+                  const std::vector<std::string> *fields, const ScanVisitor &visitor) {
+    return (this->*(method_scan_view_))(table, key, len, fields, visitor);
+  }
+
+  Status ScanRange(const std::string &table, const std::string &key, int len,
+                   const ScanBounds &bounds, const std::vector<std::string> *fields,
+                   const ScanVisitor &visitor) {
+    return (this->*(method_scan_range_))(table, key, len, bounds, fields, visitor);
+  }
+
   Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
     return (this->*(method_update_))(table, key, values);
   }
 
+  Status ReadModifyWrite(const std::string &table, const std::string &key,
+                         const std::vector<std::string> *fields, const RowVisitor &visitor,
+                         std::vector<Field> &values) {
+    return (this->*(method_read_modify_write_))(table, key, fields, visitor, values);
+  }
+
   Status Insert(const std::string &table, const std::string &key, std::vector<Field> &values) {
     return (this->*(method_insert_))(table, key, values);
   }
@@ -63,21 +91,27 @@ class LeveldbDB : public DB {
   LdbFormat format_;
 
   void GetOptions(const utils::Properties &props, leveldb::Options *opt);
-  void SerializeRow(const std::vector<Field> &values, std::string *data);
-  void DeserializeRowFilter(std::vector<Field> *values, const std::string &data,
-                            const std::vector<std::string> &fields);
-  void DeserializeRow(std::vector<Field> *values, const std::string &data);
   std::string BuildCompKey(const std::string &key, const std::string &field_name);
   std::string KeyFromCompKey(const std::string &comp_key);
   std::string FieldFromCompKey(const std::string &comp_key);
 
   Status ReadSingleEntry(const std::string &table, const std::string &key,
                          const std::vector<std::string> *fields, std::vector<Field> &result);
+  Status ReadViewSingleEntry(const std::string &table, const std::string &key,
+                             const std::vector<std::string> *fields, const RowVisitor &visitor);
   Status ScanSingleEntry(const std::string &table, const std::string &key, int len,
                          const std::vector<std::string> *fields,
                          std::vector<std::vector<Field>> &result);
+  Status ScanViewSingleEntry(const std::string &table, const std::string &key, int len,
+                             const std::vector<std::string> *fields, const ScanVisitor &visitor);
+  Status ScanRangeSingleEntry(const std::string &table, const std::string &key, int len,
+                              const ScanBounds &bounds, const std::vector<std::string> *fields,
+                              const ScanVisitor &visitor);
   Status UpdateSingleEntry(const std::string &table, const std::string &key,
                            std::vector<Field> &values);
+  Status ReadModifyWriteSingleEntry(const std::string &table, const std::string &key,
+                                    const std::vector<std::string> *fields,
+                                    const RowVisitor &visitor, std::vector<Field> &values);
   Status InsertSingleEntry(const std::string &table, const std::string &key,
                            std::vector<Field> &values);
   Status DeleteSingleEntry(const std::string &table, const std::string &key);
@@ -94,13 +128,33 @@ class LeveldbDB : public DB {
                        std::vector<std::vector<Field>> &result);
   Status InsertCompKey(const std::string &table, const std::string &key,
                        std::vector<Field> &values);
+  Status ReadViewCompKey(const std::string &table, const std::string &key,
+                         const std::vector<std::string> *fields, const RowVisitor &visitor);
+  Status ScanViewCompKey(const std::string &table, const std::string &key, int len,
+                         const std::vector<std::string> *fields, const ScanVisitor &visitor);
+  Status ScanRangeCompKey(const std::string &table, const std::string &key, int len,
+                          const ScanBounds &bounds, const std::vector<std::string> *fields,
+                          const ScanVisitor &visitor);
+  Status ReadModifyWriteCompKey(const std::string &table, const std::string &key,
+                                const std::vector<std::string> *fields,
+                                const RowVisitor &visitor, std::vector<Field> &values);
   Status DeleteCompKey(const std::string &table, const std::string &key);
 
   Status (LeveldbDB::*method_read_)(const std::string &, const std:: string &,
                                     const std::vector<std::string> *, std::vector<Field> &);
+  Status (LeveldbDB::*method_read_view_)(const std::string &, const std::string &,
+                                         const std::vector<std::string> *, const RowVisitor &);
+  Status (LeveldbDB::*method_scan_view_)(const std::string &, const std::string &, int,
+                                         const std::vector<std::string> *, const ScanVisitor &);
+  Status (LeveldbDB::*method_scan_range_)(const std::string &, const std::string &, int,
+                                          const ScanBounds &, const std::vector<std::string> *,
+                                          const ScanVisitor &);
   Status (LeveldbDB::*method_scan_)(const std::string &, const std::string &, int,
                                     const std::vector<std::string> *,
                                     std::vector<std::vector<Field>> &);
+  Status (LeveldbDB::*method_read_modify_write_)(const std::string &, const std::string &,
+                                                 const std::vector<std::string> *,
+                                                 const RowVisitor &, std::vector<Field> &);
   Status (LeveldbDB::*method_update_)(const std::string &, const std::string &,
                                       std::vector<Field> &);
   Status (LeveldbDB::*method_insert_)(const std::string &, const std::string &,
@@ -109,9 +163,20 @@ class LeveldbDB : public DB {
 
   int fieldcount_;
   std::string field_prefix_;
-
-  static leveldb::DB *db_;
-  static int ref_cnt_;
+  // value encoding of the single entry format
+  RowCodec codec_;
+  // value of the last ReadView(), kept to reuse its capacity
+  std::string read_buffer_;
+
+  leveldb::DB *db_{nullptr};
+  std::string db_path_;
+
+  // DBs open in this process by path, each shared by the instances on it
+  struct OpenDB {
+    leveldb::DB *db = nullptr;
+    int ref_cnt = 0;
+  };
+  static std::map<std::string, OpenDB> open_dbs_;
   static std::mutex mu_;
 };
 
@@ -42,16 +42,17 @@ namespace {
 
   const std::string PROP_MAPASYNC = "lmdb.mapasync";
   const std::string PROP_MAPASYNC_DEFAULT = "false";
+
+  std::string_view AsView(const MDB_val &val) {
+    return std::string_view(static_cast<const char *>(val.mv_data), val.mv_size);
+  }
 } // anonymous
 
 namespace ycsbc {
 
-size_t LmdbDB::field_count_;
-std::string LmdbDB::field_prefix_;
+RowCodec LmdbDB::codec_;
 
-MDB_env *LmdbDB::env_;
-MDB_dbi LmdbDB::dbi_;
-int LmdbDB::ref_cnt_ = 0;
+std::map<std::string, LmdbDB::OpenEnv> LmdbDB::open_envs_;
 std::mutex LmdbDB::mutex_;
 
 void LmdbDB::Init() {
@@ -59,15 +60,23 @@ void LmdbDB::Init() {
 
   const utils::Properties &props = *props_;
 
-  if (ref_cnt_++) {
+  const std::string &db_path = props.GetProperty(PROP_DBPATH, PROP_DBPATH_DEFAULT);
+  if (db_path == "") {
+    throw utils::Exception("LMDB db path is missing");
+  }
+  // the codec is shared by all environments, so it is only set while none
+  // is in use
+  if (open_envs_.empty()) {
+    codec_ = RowCodec(props);
+  }
+  db_path_ = db_path;
+  OpenEnv &open_env = open_envs_[db_path];
+  if (open_env.ref_cnt++) {
+    env_ = open_env.env;
+    dbi_ = open_env.dbi;
     return;
   }
 
-  field_count_ = std::stoi(props.GetProperty(CoreWorkload::FIELD_COUNT_PROPERTY,
-                                            CoreWorkload::FIELD_COUNT_DEFAULT));
-  field_prefix_ = props.GetProperty(CoreWorkload::FIELD_NAME_PREFIX,
-                                    CoreWorkload::FIELD_NAME_PREFIX_DEFAULT);
-
   int ret;
   int env_opt = 0;
   if (props.GetProperty(PROP_NOSYNC, PROP_NOSYNC_DEFAULT) == "true") {
@@ -96,10 +105,6 @@ void LmdbDB::Init() {
       throw utils::Exception(std::string("Init mdb_env_set_mapsize: ") + mdb_strerror(ret));
     }
   }
-  const std::string &db_path = props.GetProperty(PROP_DBPATH, PROP_DBPATH_DEFAULT);
-  if (db_path == "") {
-    throw utils::Exception("LMDB db path is missing");
-  }
   ret = mkdir(db_path.c_str(), 0775);
   if (ret && errno != EEXIST) {
     throw utils::Exception(std::string("Init mkdir: ") + strerror(errno));
@@ -122,98 +127,89 @@ void LmdbDB::Init() {
   if (ret) {
     throw utils::Exception(std::string("Init mdb_txn_commit: ") + mdb_strerror(ret));
   }
+  open_env.env = env_;
+  open_env.dbi = dbi_;
 }
 
 void LmdbDB::Cleanup() {
   const std::lock_guard<std::mutex> lock(mutex_);
-  if (--ref_cnt_) {
+  env_ = nullptr;
+  OpenEnv &open_env = open_envs_[db_path_];
+  if (--open_env.ref_cnt) {
     return;
   }
-  mdb_close(env_, dbi_);
-  mdb_env_close(env_);
+  mdb_close(open_env.env, open_env.dbi);
+  mdb_env_close(open_env.env);
+  open_envs_.erase(db_path_);
 }
 
-void LmdbDB::SerializeRow(const std::vector<Field> &values, std::string *data) {
-  for (const Field &field : values) {
-    uint32_t len = field.name.size();
-    data->append(reinterpret_cast<char *>(&len), sizeof(uint32_t));
-    data->append(field.name.data(), field.name.size());
-    len = field.value.size();
-    data->append(reinterpret_cast<char *>(&len), sizeof(uint32_t));
-    data->append(field.value.data(), field.value.size());
+void LmdbDB::GetStats(std::vector<Field> &stats) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if (env_ == nullptr) {
+    return;
   }
-}
-
-void LmdbDB::DeserializeRowFilter(std::vector<Field> *values, const char *data_ptr, size_t data_len,
-                                  const std::vector<std::string> &fields) {
-  const char *p = data_ptr;
-  const char *lim = p + data_len;
-  std::vector<std::string>::const_iterator filter_iter = fields.begin();
-  while (p != lim && filter_iter != fields.end()) {
-    assert(p < lim);
-    uint32_t len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string field(p, static_cast<const size_t>(len));
-    p += len;
-    len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string value(p, static_cast<const size_t>(len));
-    p += len;
-    if (*filter_iter == field) {
-      values->push_back({field, value});
-      filter_iter++;
-    }
+  MDB_envinfo info;
+  if (mdb_env_info(env_, &info) == 0) {
+    stats.push_back({"lmdb.mapsize", std::to_string(info.me_mapsize)});
+    stats.push_back({"lmdb.last_pgno", std::to_string(info.me_last_pgno)});
+    stats.push_back({"lmdb.last_txnid", std::to_string(info.me_last_txnid)});
+    stats.push_back({"lmdb.numreaders", std::to_string(info.me_numreaders)});
+  }
+  // the records are stored in the main db, which mdb_env_stat() describes
+  MDB_stat stat;
+  if (mdb_env_stat(env_, &stat) == 0) {
+    stats.push_back({"lmdb.depth", std::to_string(stat.ms_depth)});
+    stats.push_back({"lmdb.branch_pages", std::to_string(stat.ms_branch_pages)});
+    stats.push_back({"lmdb.leaf_pages", std::to_string(stat.ms_leaf_pages)});
+    stats.push_back({"lmdb.overflow_pages", std::to_string(stat.ms_overflow_pages)});
+    stats.push_back({"lmdb.entries", std::to_string(stat.ms_entries)});
   }
-  assert(values->size() == fields.size());
 }
 
-void LmdbDB::DeserializeRow(std::vector<Field> *values, const char *data_ptr, size_t data_len) {
-  const char *p = data_ptr;
-  const char *lim = p + data_len;
-  while (p != lim) {
-    assert(p < lim);
-    uint32_t len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string field(p, static_cast<const size_t>(len));
-    p += len;
-    len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string value(p, static_cast<const size_t>(len));
-    p += len;
-    values->push_back({field, value});
-  }
-  assert(values->size() == field_count_);
+std::string LmdbDB::GetDataPath() {
+  return props_->GetProperty(PROP_DBPATH, PROP_DBPATH_DEFAULT);
 }
 
 DB::Status LmdbDB::Read(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
                         std::vector<Field> &result) {
-  DB::Status s = kOK;
+  MDB_txn *txn;
+  int ret;
+  ret = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
+  if (ret) {
+    throw utils::Exception(std::string("Read mdb_txn_begin: ") + mdb_strerror(ret));
+  }
+  DB::Status s = ReadTxn(txn, key, fields, result);
+  mdb_txn_abort(txn);
+  return s;
+}
+
+DB::Status LmdbDB::ReadView(const std::string &table, const std::string &key,
+                            const std::vector<std::string> *fields, const RowVisitor &visitor) {
   MDB_txn *txn;
   MDB_val key_slice, val_slice;
 
   key_slice.mv_data = static_cast<void *>(const_cast<char *>(key.data()));
   key_slice.mv_size = key.size();
 
-  int ret;
-  ret = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
+  int ret = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
   if (ret) {
     throw utils::Exception(std::string("Read mdb_txn_begin: ") + mdb_strerror(ret));
   }
   ret = mdb_get(txn, dbi_, &key_slice, &val_slice);
   if (ret == MDB_NOTFOUND) {
-    s = kNotFound;
-    goto cleanup;
+    mdb_txn_abort(txn);
+    return kNotFound;
   } else if (ret) {
+    mdb_txn_abort(txn);
     throw utils::Exception(std::string("Read mdb_get: ") + mdb_strerror(ret));
   }
-  if (fields != nullptr) {
-    DeserializeRowFilter(&result, static_cast<char *>(val_slice.mv_data), val_slice.mv_size, *fields);
-  } else {
-    DeserializeRow(&result, static_cast<char *>(val_slice.mv_data), val_slice.mv_size);
-  }
-cleanup:
+  // val_slice points into the memory map, valid until the transaction ends
+  const char *data = static_cast<const char *>(val_slice.mv_data);
+  std::vector<FieldView> values;
+  codec_.DecodeView(data, data + val_slice.mv_size, fields, values);
+  visitor(values);
   mdb_txn_abort(txn);
-  return s;
+  return kOK;
 }
 
 DB::Status LmdbDB::Scan(const std::string &table, const std::string &key, int len,
@@ -243,13 +239,9 @@ DB::Status LmdbDB::Scan(const std::string &table, const std::string &key, int le
     throw utils::Exception(std::string("Scan mdb_cursor_get: ") + mdb_strerror(ret));
   }
   for (int i = 0; !ret && i < len; i++) {
+    const char *data = static_cast<const char *>(val_slice.mv_data);
     result.push_back(std::vector<Field>());
-    std::vector<Field> &values = result.back();
-    if (fields != nullptr) {
-      DeserializeRowFilter(&values, static_cast<char *>(val_slice.mv_data), val_slice.mv_size, *fields);
-    } else {
-      DeserializeRow(&values, static_cast<char *>(val_slice.mv_data), val_slice.mv_size);
-    }
+    codec_.Decode(data, data + val_slice.mv_size, fields, result.back());
     ret = mdb_cursor_get(cursor, &key_slice, &val_slice, MDB_NEXT);
   }
 cleanup:
@@ -258,45 +250,77 @@ cleanup:
   return s;
 }
 
-DB::Status LmdbDB::Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
+DB::Status LmdbDB::ScanView(const std::string &table, const std::string &key, int len,
+                            const std::vector<std::string> *fields, const ScanVisitor &visitor) {
+  return ScanRange(table, key, len, ScanBounds(), fields, visitor);
+}
+
+DB::Status LmdbDB::ScanRange(const std::string &table, const std::string &key, int len,
+                             const ScanBounds &bounds, const std::vector<std::string> *fields,
+                             const ScanVisitor &visitor) {
   MDB_txn *txn;
+  MDB_cursor *cursor;
   MDB_val key_slice, val_slice;
+  std::vector<FieldView> values;
+  const MDB_cursor_op step = bounds.reverse ? MDB_PREV : MDB_NEXT;
 
   key_slice.mv_data = static_cast<void *>(const_cast<char *>(key.data()));
   key_slice.mv_size = key.size();
 
   int ret;
-  ret = mdb_txn_begin(env_, nullptr, 0, &txn);
+  ret = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
   if (ret) {
-    throw utils::Exception(std::string("Update mdb_txn_begin: ") + mdb_strerror(ret));
+    throw utils::Exception(std::string("Scan mdb_txn_begin: ") + mdb_strerror(ret));
   }
-  ret = mdb_get(txn, dbi_, &key_slice, &val_slice);
+  ret = mdb_cursor_open(txn, dbi_, &cursor);
   if (ret) {
-    throw utils::Exception(std::string("Update mdb_get: ") + mdb_strerror(ret));
+    throw utils::Exception(std::string("Scan mdb_cursor_open: ") + mdb_strerror(ret));
   }
-  std::vector<Field> current_values;
-  DeserializeRow(&current_values, static_cast<char *>(val_slice.mv_data), val_slice.mv_size);
-  for (Field &new_field : values) {
-    bool found MAYBE_UNUSED = false;
-    for (Field &cur_field : current_values) {
-      if (cur_field.name == new_field.name) {
-        found = true;
-        cur_field.value = new_field.value;
+  // positions at the first key at or after the start key
+  ret = mdb_cursor_get(cursor, &key_slice, &val_slice, MDB_SET_RANGE);
+  if (bounds.reverse) {
+    if (ret == MDB_NOTFOUND) {
+      ret = mdb_cursor_get(cursor, &key_slice, &val_slice, MDB_LAST);
+    } else if (!ret && AsView(key_slice) != key) {
+      ret = mdb_cursor_get(cursor, &key_slice, &val_slice, MDB_PREV);
+    }
+  }
+  for (int i = 0; !ret && i < len; i++) {
+    if (!bounds.end_key.empty()) {
+      int c = AsView(key_slice).compare(bounds.end_key);
+      if (bounds.reverse ? c <= 0 : c >= 0) {
         break;
       }
     }
-    assert(found);
+    // val_slice points into the memory map, valid until the transaction ends
+    const char *data = static_cast<const char *>(val_slice.mv_data);
+    values.clear();
+    codec_.DecodeView(data, data + val_slice.mv_size, fields, values);
+    if (!visitor(AsView(key_slice), values)) {
+      break;
+    }
+    ret = mdb_cursor_get(cursor, &key_slice, &val_slice, step);
   }
+  if (ret && ret != MDB_NOTFOUND) {
+    throw utils::Exception(std::string("Scan mdb_cursor_get: ") + mdb_strerror(ret));
+  }
+  mdb_cursor_close(cursor);
+  mdb_txn_abort(txn);
+  return kOK;
+}
 
-  std::string data;
-  SerializeRow(current_values, &data);
-  val_slice.mv_data = const_cast<char *>(data.data());
-  val_slice.mv_size = data.size();
-  ret = mdb_put(txn, dbi_, &key_slice, &val_slice, 0);
+DB::Status LmdbDB::Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
+  MDB_txn *txn;
+  int ret;
+  ret = mdb_txn_begin(env_, nullptr, 0, &txn);
   if (ret) {
-    throw utils::Exception(std::string("Update mdb_put: ") + mdb_strerror(ret));
+    throw utils::Exception(std::string("Update mdb_txn_begin: ") + mdb_strerror(ret));
+  }
+  DB::Status s = UpdateTxn(txn, key, values);
+  if (s != kOK) {
+    mdb_txn_abort(txn);
+    return s;
   }
-
   ret = mdb_txn_commit(txn);
   if (ret) {
     throw utils::Exception(std::string("Update mdb_txn_commit: ") + mdb_strerror(ret));
@@ -304,6 +328,27 @@ DB::Status LmdbDB::Update(const std::string &table, const std::string &key, std:
   return kOK;
 }
 
+DB::Status LmdbDB::ReadModifyWrite(const std::string &table, const std::string &key,
+                                   const std::vector<std::string> *fields,
+                                   const RowVisitor &visitor, std::vector<Field> &values) {
+  MDB_txn *txn;
+  // the write transaction excludes other writers from the read to the commit
+  int ret = mdb_txn_begin(env_, nullptr, 0, &txn);
+  if (ret) {
+    throw utils::Exception(std::string("ReadModifyWrite mdb_txn_begin: ") + mdb_strerror(ret));
+  }
+  DB::Status s = UpdateTxn(txn, key, values, fields, &visitor);
+  if (s != kOK) {
+    mdb_txn_abort(txn);
+    return s;
+  }
+  ret = mdb_txn_commit(txn);
+  if (ret) {
+    throw utils::Exception(std::string("ReadModifyWrite mdb_txn_commit: ") + mdb_strerror(ret));
+  }
+  return kOK;
+}
+
 DB::Status LmdbDB::Insert(const std::string &table, const std::string &key, std::vector<Field> &values) {
   MDB_txn *txn;
   MDB_val key_slice, val_slice;
@@ -312,7 +357,7 @@ DB::Status LmdbDB::Insert(const std::string &table, const std::string &key, std:
   key_slice.mv_size = key.size();
 
   std::string data;
-  SerializeRow(values, &data);
+  codec_.Encode(values, data);
   val_slice.mv_data = static_cast<void *>(const_cast<char *>(data.data()));
   val_slice.mv_size = data.size();
 
@@ -355,6 +400,95 @@ DB::Status LmdbDB::Delete(const std::string &table, const std::string &key) {
   return kOK;
 }
 
+DB::Status LmdbDB::ReadTxn(MDB_txn *txn, const std::string &key, const std::vector<std::string> *fields,
+                           std::vector<Field> &result) {
+  MDB_val key_slice, val_slice;
+
+  key_slice.mv_data = static_cast<void *>(const_cast<char *>(key.data()));
+  key_slice.mv_size = key.size();
+
+  int ret = mdb_get(txn, dbi_, &key_slice, &val_slice);
+  if (ret == MDB_NOTFOUND) {
+    return kNotFound;
+  } else if (ret) {
+    throw utils::Exception(std::string("Read mdb_get: ") + mdb_strerror(ret));
+  }
+  const char *data = static_cast<const char *>(val_slice.mv_data);
+  codec_.Decode(data, data + val_slice.mv_size, fields, result);
+  return kOK;
+}
+
+DB::Status LmdbDB::UpdateTxn(MDB_txn *txn, const std::string &key, std::vector<Field> &values,
+                             const std::vector<std::string> *fields, const RowVisitor *visitor) {
+  MDB_val key_slice, val_slice;
+
+  key_slice.mv_data = static_cast<void *>(const_cast<char *>(key.data()));
+  key_slice.mv_size = key.size();
+
+  int ret = mdb_get(txn, dbi_, &key_slice, &val_slice);
+  if (ret == MDB_NOTFOUND) {
+    return kNotFound;
+  } else if (ret) {
+    throw utils::Exception(std::string("Update mdb_get: ") + mdb_strerror(ret));
+  }
+  const char *current = static_cast<const char *>(val_slice.mv_data);
+  if (visitor != nullptr) {
+    std::vector<FieldView> current_values;
+    codec_.DecodeView(current, current + val_slice.mv_size, fields, current_values);
+    (*visitor)(current_values);
+  }
+  std::string data;
+  codec_.Update(current, current + val_slice.mv_size, values, data);
+  val_slice.mv_data = const_cast<char *>(data.data());
+  val_slice.mv_size = data.size();
+  ret = mdb_put(txn, dbi_, &key_slice, &val_slice, 0);
+  if (ret) {
+    throw utils::Exception(std::string("Update mdb_put: ") + mdb_strerror(ret));
+  }
+  return kOK;
+}
+
+class LmdbDB::LmdbTransaction : public DB::Transaction {
+ public:
+  LmdbTransaction(LmdbDB *db, MDB_txn *txn) : db_(db), txn_(txn) {}
+
+  Status Read(const std::string &table, const std::string &key,
+              const std::vector<std::string> *fields, std::vector<Field> &result) {
+    return db_->ReadTxn(txn_, key, fields, result);
+  }
+
+  Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
+    return db_->UpdateTxn(txn_, key, values);
+  }
+
+  Status Commit() {
+    int ret = mdb_txn_commit(txn_);
+    if (ret) {
+      throw utils::Exception(std::string("Commit mdb_txn_commit: ") + mdb_strerror(ret));
+    }
+    return kOK;
+  }
+
+  void Rollback() {
+    mdb_txn_abort(txn_);
+  }
+
+ private:
+  LmdbDB *db_;
+  MDB_txn *txn_;
+};
+
+DB::Status LmdbDB::BeginTransaction(Transaction **txn) {
+  MDB_txn *mdb_txn;
+  // LMDB serializes write transactions, so transactions never abort on conflicts
+  int ret = mdb_txn_begin(env_, nullptr, 0, &mdb_txn);
+  if (ret) {
+    throw utils::Exception(std::string("BeginTransaction mdb_txn_begin: ") + mdb_strerror(ret));
+  }
+  *txn = new LmdbTransaction(this, mdb_txn);
+  return kOK;
+}
+
 DB *NewLmdbDB() {
   return new LmdbDB;
 }
@@ -8,10 +8,12 @@
 #ifndef YCSB_C_LMDB_DB_H_
 #define YCSB_C_LMDB_DB_H_
 
+#include <map>
 #include <string>
 #include <mutex>
 
 #include "core/db.h"
+#include "core/row_codec.h"
 
 #include <lmdb.h>
 
@@ -26,30 +28,65 @@ class LmdbDB : public DB {
 
   void Cleanup();
 
+  void GetStats(std::vector<Field> &stats);
+
+  std::string GetDataPath();
+
   Status Read(const std::string &table, const std::string &key,
               const std::vector<std::string> *fields, std::vector<Field> &result);
 
+  Status ReadView(const std::string &table, const std::string &key,
+                  const std::vector<std::string> *fields, const RowVisitor &visitor);
+
   Status Scan(const std::string &table, const std::string &key, int len,
               const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result);
 
+  Status ScanView(const std::string &table, const std::string &key, int len,
+                  const std::vector<std::string> *fields, const ScanVisitor &visitor);
+
+  Status ScanRange(const std::string &table, const std::string &key, int len,
+                   const ScanBounds &bounds, const std::vector<std::string> *fields,
+                   const ScanVisitor &visitor);
+
   Status Update(const std::string &table, const std::string &key, std::vector<Field> &values);
 
+  Status ReadModifyWrite(const std::string &table, const std::string &key,
+                         const std::vector<std::string> *fields, const RowVisitor &visitor,
+                         std::vector<Field> &values);
+
   Status Insert(const std::string &table, const std::string &key, std::vector<Field> &values);
 
   Status Delete(const std::string &table, const std::string &key);
 
- private:
-  void SerializeRow(const std::vector<Field> &values, std::string *data);
-  void DeserializeRowFilter(std::vector<Field> *values, const char *data_ptr, size_t data_len,
-                            const std::vector<std::string> &fields);
-  void DeserializeRow(std::vector<Field> *values, const char *data_ptr, size_t data_len);
-
-  static size_t field_count_;
-  static std::string field_prefix_;
+  Status BeginTransaction(Transaction **txn);
 
-  static MDB_env *env_;
-  static MDB_dbi dbi_;
-  static int ref_cnt_;
+ private:
+  class LmdbTransaction;
+
+  Status ReadTxn(MDB_txn *txn, const std::string &key, const std::vector<std::string> *fields,
+                 std::vector<Field> &result);
+  ///
+  /// Updates the record in txn, first passing the fields read to visitor
+  /// if it is not null.
+  ///
+  Status UpdateTxn(MDB_txn *txn, const std::string &key, std::vector<Field> &values,
+                   const std::vector<std::string> *fields = nullptr,
+                   const RowVisitor *visitor = nullptr);
+
+  static RowCodec codec_;
+
+  MDB_env *env_{nullptr};
+  MDB_dbi dbi_;
+  std::string db_path_;
+
+  // environments open in this process by path, each shared by the
+  // instances on it
+  struct OpenEnv {
+    MDB_env *env = nullptr;
+    MDB_dbi dbi;
+    int ref_cnt = 0;
+  };
+  static std::map<std::string, OpenEnv> open_envs_;
   static std::mutex mutex_;
 };
 
@@ -12,9 +12,17 @@
 #include "core/db_factory.h"
 #include "utils/utils.h"
 
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+
 #include <rocksdb/cache.h>
+#include <rocksdb/env.h>
 #include <rocksdb/filter_policy.h>
 #include <rocksdb/merge_operator.h>
+#include <rocksdb/sst_file_writer.h>
+#include <rocksdb/statistics.h>
 #include <rocksdb/status.h>
 #include <rocksdb/utilities/options_util.h>
 #include <rocksdb/write_batch.h>
@@ -107,6 +115,21 @@ namespace {
   const std::string PROP_SYNC = "rocksdb.sync";
   const std::string PROP_SYNC_DEFAULT = "false";
 
+  const std::string PROP_BULKLOAD = "rocksdb.bulkload";
+  const std::string PROP_BULKLOAD_DEFAULT = "false";
+
+  const std::string PROP_BULKLOAD_DIR = "rocksdb.bulkload.dir";
+  const std::string PROP_BULKLOAD_DIR_DEFAULT = "";
+
+  const std::string PROP_BULKLOAD_BUFFER_SIZE = "rocksdb.bulkload.buffer_size";
+  const std::string PROP_BULKLOAD_BUFFER_SIZE_DEFAULT = "268435456";
+
+  const std::string PROP_TRANSACTION = "rocksdb.transaction";
+  const std::string PROP_TRANSACTION_DEFAULT = "none";
+
+  const std::string PROP_STATISTICS = "rocksdb.statistics";
+  const std::string PROP_STATISTICS_DEFAULT = "false";
+
   static std::shared_ptr<rocksdb::Env> env_guard;
   static std::shared_ptr<rocksdb::Cache> block_cache;
 #if ROCKSDB_MAJOR < 8
@@ -116,10 +139,9 @@ namespace {
 
 namespace ycsbc {
 
-std::vector<rocksdb::ColumnFamilyHandle *> RocksdbDB::cf_handles_;
-rocksdb::DB *RocksdbDB::db_ = nullptr;
-int RocksdbDB::ref_cnt_ = 0;
+std::map<std::string, RocksdbDB::OpenDB> RocksdbDB::open_dbs_;
 std::mutex RocksdbDB::mu_;
+RowCodec RocksdbDB::codec_;
 rocksdb::WriteOptions RocksdbDB::wopt_;
 
 void RocksdbDB::Init() {
@@ -132,31 +154,10 @@ void RocksdbDB::Init() {
                        rocksdb::Logger *logger) const override {
       assert(existing_value);
 
-      std::vector<Field> values;
-      const char *p = existing_value->data();
-      const char *lim = p + existing_value->size();
-      DeserializeRow(values, p, lim);
-
       std::vector<Field> new_values;
-      p = value.data();
-      lim = p + value.size();
-      DeserializeRow(new_values, p, lim);
-
-      for (Field &new_field : new_values) {
-        bool found = false;
-        for (Field &field : values) {
-          if (field.name == new_field.name) {
-            found = true;
-            field.value = new_field.value;
-            break;
-          }
-        }
-        if (!found) {
-          values.push_back(new_field);
-        }
-      }
-
-      SerializeRow(values, *new_value);
+      codec_.Decode(value.data(), value.data() + value.size(), nullptr, new_values);
+      codec_.Update(existing_value->data(), existing_value->data() + existing_value->size(),
+                    new_values, *new_value);
       return true;
     }
 
@@ -172,8 +173,12 @@ void RocksdbDB::Init() {
   if (format == "single") {
     format_ = kSingleRow;
     method_read_ = &RocksdbDB::ReadSingle;
+    method_read_view_ = &RocksdbDB::ReadViewSingle;
     method_scan_ = &RocksdbDB::ScanSingle;
+    method_scan_view_ = &RocksdbDB::ScanViewSingle;
+    method_scan_range_ = &RocksdbDB::ScanRangeSingle;
     method_update_ = &RocksdbDB::UpdateSingle;
+    method_read_modify_write_ = &RocksdbDB::ReadModifyWriteSingle;
     method_insert_ = &RocksdbDB::InsertSingle;
     method_delete_ = &RocksdbDB::DeleteSingle;
 #ifdef USE_MERGEUPDATE
@@ -184,18 +189,33 @@ void RocksdbDB::Init() {
   } else {
     throw utils::Exception("unknown format");
   }
-  fieldcount_ = std::stoi(props.GetProperty(CoreWorkload::FIELD_COUNT_PROPERTY,
-                                            CoreWorkload::FIELD_COUNT_DEFAULT));
-
-  ref_cnt_++;
-  if (db_) {
-    return;
-  }
 
+  // bulk load only applies to the load phase, inserts of the run phase go to the memtable
+  const bool bulkload = props.GetProperty(PROP_BULKLOAD, PROP_BULKLOAD_DEFAULT) == "true" &&
+                        props.GetProperty("doload", "false") == "true";
   const std::string &db_path = props.GetProperty(PROP_NAME, PROP_NAME_DEFAULT);
   if (db_path == "") {
     throw utils::Exception("RocksDB db path is missing");
   }
+  // the codec is shared by all DBs, so it is only set while none is in use
+  if (open_dbs_.empty()) {
+    codec_ = RowCodec(props);
+  }
+  db_path_ = db_path;
+  OpenDB &open_db = open_dbs_[db_path];
+  if (bulkload) {
+    method_insert_ = &RocksdbDB::InsertBulk;
+    bulk_buffer_size_ = std::stoul(props.GetProperty(PROP_BULKLOAD_BUFFER_SIZE,
+                                                     PROP_BULKLOAD_BUFFER_SIZE_DEFAULT));
+    open_db.bulk_ref_cnt++;
+  }
+
+  if (open_db.ref_cnt++) {
+    db_ = open_db.db;
+    txn_db_ = open_db.txn_db;
+    otxn_db_ = open_db.otxn_db;
+    return;
+  }
 
   rocksdb::Options opt;
   opt.create_if_missing = true;
@@ -212,28 +232,118 @@ void RocksdbDB::Init() {
       throw utils::Exception(std::string("RocksDB DestroyDB: ") + s.ToString());
     }
   }
-  if (cf_descs.empty()) {
-    s = rocksdb::DB::Open(opt, db_path, &db_);
+  const std::string txn_mode = props.GetProperty(PROP_TRANSACTION, PROP_TRANSACTION_DEFAULT);
+  if (txn_mode == "pessimistic") {
+    rocksdb::TransactionDBOptions txn_db_opt;
+    if (cf_descs.empty()) {
+      s = rocksdb::TransactionDB::Open(opt, txn_db_opt, db_path, &txn_db_);
+    } else {
+      s = rocksdb::TransactionDB::Open(opt, txn_db_opt, db_path, cf_descs, &open_db.cf_handles,
+                                       &txn_db_);
+    }
+    db_ = txn_db_;
+  } else if (txn_mode == "optimistic") {
+    if (cf_descs.empty()) {
+      s = rocksdb::OptimisticTransactionDB::Open(opt, db_path, &otxn_db_);
+    } else {
+      s = rocksdb::OptimisticTransactionDB::Open(opt, db_path, cf_descs, &open_db.cf_handles,
+                                                 &otxn_db_);
+    }
+    db_ = otxn_db_;
+  } else if (txn_mode == "none") {
+    if (cf_descs.empty()) {
+      s = rocksdb::DB::Open(opt, db_path, &db_);
+    } else {
+      s = rocksdb::DB::Open(opt, db_path, cf_descs, &open_db.cf_handles, &db_);
+    }
   } else {
-    s = rocksdb::DB::Open(opt, db_path, cf_descs, &cf_handles_, &db_);
+    throw utils::Exception("unknown transaction mode");
   }
   if (!s.ok()) {
     throw utils::Exception(std::string("RocksDB Open: ") + s.ToString());
   }
+  open_db.db = db_;
+  open_db.txn_db = txn_db_;
+  open_db.otxn_db = otxn_db_;
+  open_db.statistics = opt.statistics;
+
+  if (bulkload) {
+    open_db.bulk_dir = props.GetProperty(PROP_BULKLOAD_DIR, PROP_BULKLOAD_DIR_DEFAULT);
+    if (open_db.bulk_dir == "") {
+      open_db.bulk_dir = db_path + ".bulkload";
+    }
+    rocksdb::Env *env = opt.env ? opt.env : rocksdb::Env::Default();
+    s = env->CreateDirIfMissing(open_db.bulk_dir);
+    if (!s.ok()) {
+      throw utils::Exception(std::string("RocksDB CreateDirIfMissing: ") + s.ToString());
+    }
+  }
 }
 
 void RocksdbDB::Cleanup() { 
   const std::lock_guard<std::mutex> lock(mu_);
-  if (--ref_cnt_) {
+  db_ = nullptr;
+  txn_db_ = nullptr;
+  otxn_db_ = nullptr;
+  OpenDB &open_db = open_dbs_[db_path_];
+  if (--open_db.ref_cnt) {
     return;
   }
-  for (size_t i = 0; i < cf_handles_.size(); i++) {
-    if (cf_handles_[i] != nullptr) {
-      db_->DestroyColumnFamilyHandle(cf_handles_[i]);
-      cf_handles_[i] = nullptr;
-    }
+  for (rocksdb::ColumnFamilyHandle *cf_handle : open_db.cf_handles) {
+    open_db.db->DestroyColumnFamilyHandle(cf_handle);
+  }
+  delete open_db.db;
+  open_dbs_.erase(db_path_);
+}
+
+void RocksdbDB::FinishLoad() {
+  if (method_insert_ != &RocksdbDB::InsertBulk) {
+    return;
+  }
+  FlushBulkBuffer();
+  method_insert_ = &RocksdbDB::InsertSingle;
+
+  // the last instance to finish ingests the files of all of them
+  std::vector<rocksdb::ExternalSstFileInfo> files;
+  std::string bulk_dir;
+  {
+    const std::lock_guard<std::mutex> lock(mu_);
+    OpenDB &open_db = open_dbs_[db_path_];
+    if (--open_db.bulk_ref_cnt) {
+      return;
+    }
+    files.swap(open_db.bulk_files);
+    bulk_dir = open_db.bulk_dir;
   }
-  delete db_;
+  if (files.empty()) {
+    return;
+  }
+  std::vector<std::pair<std::string, std::string>> ranges;
+  std::vector<std::string> ingest;
+  for (const rocksdb::ExternalSstFileInfo &file : files) {
+    ranges.emplace_back(file.smallest_key, file.largest_key);
+    ingest.push_back(file.file_path);
+  }
+  std::sort(ranges.begin(), ranges.end());
+  bool overlap = false;
+  for (size_t i = 1; i < ranges.size(); i++) {
+    overlap |= ranges[i].first <= ranges[i - 1].second;
+  }
+  // files that do not overlap are placed directly into the bottommost level.
+  // Overlapping ones, unless the threads loaded disjoint key ranges, get
+  // increasing sequence numbers in the order they were written, so that the
+  // record written last wins, and are placed by RocksDB, partly into L0
+  rocksdb::IngestExternalFileOptions ifo;
+  ifo.move_files = true;
+  ifo.allow_global_seqno = true;
+  rocksdb::Status s = db_->IngestExternalFile(ingest, ifo);
+  if (!s.ok()) {
+    throw utils::Exception(std::string("RocksDB IngestExternalFile: ") + s.ToString());
+  }
+  db_->GetEnv()->DeleteDir(bulk_dir);
+  std::cout << "RocksDB bulk load: ingested " << files.size() << " files"
+            << (overlap ? " with overlapping key ranges" : " into the bottommost level")
+            << ", load INSERT latencies only cover buffering the records" << std::endl;
 }
 
 void RocksdbDB::GetOptions(const utils::Properties &props, rocksdb::Options *opt,
@@ -372,66 +482,71 @@ void RocksdbDB::GetOptions(const utils::Properties &props, rocksdb::Options *opt
       wopt_.sync = true;
     }
   }
-}
 
-void RocksdbDB::SerializeRow(const std::vector<Field> &values, std::string &data) {
-  for (const Field &field : values) {
-    uint32_t len = field.name.size();
-    data.append(reinterpret_cast<char *>(&len), sizeof(uint32_t));
-    data.append(field.name.data(), field.name.size());
-    len = field.value.size();
-    data.append(reinterpret_cast<char *>(&len), sizeof(uint32_t));
-    data.append(field.value.data(), field.value.size());
+  if (props.GetProperty(PROP_STATISTICS, PROP_STATISTICS_DEFAULT) == "true") {
+    opt->statistics = rocksdb::CreateDBStatistics();
   }
 }
 
-void RocksdbDB::DeserializeRowFilter(std::vector<Field> &values, const char *p, const char *lim,
-                                     const std::vector<std::string> &fields) {
-  std::vector<std::string>::const_iterator filter_iter = fields.begin();
-  while (p != lim && filter_iter != fields.end()) {
-    assert(p < lim);
-    uint32_t len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string field(p, static_cast<const size_t>(len));
-    p += len;
-    len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string value(p, static_cast<const size_t>(len));
-    p += len;
-    if (*filter_iter == field) {
-      values.push_back({field, value});
-      filter_iter++;
-    }
-  }
-  assert(values.size() == fields.size());
-}
+void RocksdbDB::GetStats(std::vector<Field> &stats) {
+  const std::lock_guard<std::mutex> lock(mu_);
+  if (db_ == nullptr) {
+    return;
+  }
+  const std::string int_props[] = {
+    rocksdb::DB::Properties::kEstimatePendingCompactionBytes,
+    rocksdb::DB::Properties::kNumRunningCompactions,
+    rocksdb::DB::Properties::kNumRunningFlushes,
+    rocksdb::DB::Properties::kCurSizeAllMemTables,
+    rocksdb::DB::Properties::kNumImmutableMemTable,
+    rocksdb::DB::Properties::kActualDelayedWriteRate,
+    rocksdb::DB::Properties::kIsWriteStopped,
+    rocksdb::DB::Properties::kBlockCacheUsage,
+  };
+  for (const std::string &name : int_props) {
+    uint64_t value;
+    if (db_->GetIntProperty(name, &value)) {
+      stats.push_back({name, std::to_string(value)});
+    }
+  }
 
-void RocksdbDB::DeserializeRowFilter(std::vector<Field> &values, const std::string &data,
-                                     const std::vector<std::string> &fields) {
-  const char *p = data.data();
-  const char *lim = p + data.size();
-  DeserializeRowFilter(values, p, lim, fields);
-}
+  // cumulative write stall counts of the default column family
+  std::map<std::string, std::string> stall_stats;
+#if ROCKSDB_MAJOR > 8 || (ROCKSDB_MAJOR == 8 && ROCKSDB_MINOR >= 2)
+  const std::string &stall_prop = rocksdb::DB::Properties::kCFWriteStallStats;
+  const std::string stall_prefix = "";
+#else
+  const std::string &stall_prop = rocksdb::DB::Properties::kCFStats;
+  const std::string stall_prefix = "io_stalls.";
+#endif
+  if (db_->GetMapProperty(stall_prop, &stall_stats)) {
+    for (const auto &stat : stall_stats) {
+      if (stat.first.compare(0, stall_prefix.size(), stall_prefix) == 0) {
+        stats.push_back({stall_prop + "." + stat.first.substr(stall_prefix.size()), stat.second});
+      }
+    }
+  }
 
-void RocksdbDB::DeserializeRow(std::vector<Field> &values, const char *p, const char *lim) {
-  while (p != lim) {
-    assert(p < lim);
-    uint32_t len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string field(p, static_cast<const size_t>(len));
-    p += len;
-    len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string value(p, static_cast<const size_t>(len));
-    p += len;
-    values.push_back({field, value});
+  OpenDB &open_db = open_dbs_[db_path_];
+  const std::shared_ptr<rocksdb::Statistics> &statistics = open_db.statistics;
+  if (statistics) {
+    uint64_t hits = statistics->getTickerCount(rocksdb::BLOCK_CACHE_HIT);
+    uint64_t misses = statistics->getTickerCount(rocksdb::BLOCK_CACHE_MISS);
+    uint64_t lookups = (hits - open_db.last_cache_hits) + (misses - open_db.last_cache_misses);
+    double hit_rate = lookups > 0 ? static_cast<double>(hits - open_db.last_cache_hits) / lookups : 0;
+    open_db.last_cache_hits = hits;
+    open_db.last_cache_misses = misses;
+    stats.push_back({"rocksdb.block.cache.hit", std::to_string(hits)});
+    stats.push_back({"rocksdb.block.cache.miss", std::to_string(misses)});
+    // over the lookups since the previous call
+    stats.push_back({"rocksdb.block.cache.hit.rate", std::to_string(hit_rate)});
+    stats.push_back({"rocksdb.stall.micros",
+                     std::to_string(statistics->getTickerCount(rocksdb::STALL_MICROS))});
   }
 }
 
-void RocksdbDB::DeserializeRow(std::vector<Field> &values, const std::string &data) {
-  const char *p = data.data();
-  const char *lim = p + data.size();
-  DeserializeRow(values, p, lim);
+std::string RocksdbDB::GetDataPath() {
+  return props_->GetProperty(PROP_NAME, PROP_NAME_DEFAULT);
 }
 
 DB::Status RocksdbDB::ReadSingle(const std::string &table, const std::string &key,
@@ -444,12 +559,24 @@ DB::Status RocksdbDB::ReadSingle(const std::string &table, const std::string &ke
   } else if (!s.ok()) {
     throw utils::Exception(std::string("RocksDB Get: ") + s.ToString());
   }
-  if (fields != nullptr) {
-    DeserializeRowFilter(result, data, *fields);
-  } else {
-    DeserializeRow(result, data);
-    assert(result.size() == static_cast<size_t>(fieldcount_));
+  codec_.Decode(data, fields, result);
+  return kOK;
+}
+
+DB::Status RocksdbDB::ReadViewSingle(const std::string &table, const std::string &key,
+                                     const std::vector<std::string> *fields,
+                                     const RowVisitor &visitor) {
+  // pins the block cache entry instead of copying the value out of it
+  rocksdb::PinnableSlice data;
+  rocksdb::Status s = db_->Get(rocksdb::ReadOptions(), db_->DefaultColumnFamily(), key, &data);
+  if (s.IsNotFound()) {
+    return kNotFound;
+  } else if (!s.ok()) {
+    throw utils::Exception(std::string("RocksDB Get: ") + s.ToString());
   }
+  std::vector<FieldView> values;
+  codec_.DecodeView(data.data(), data.data() + data.size(), fields, values);
+  visitor(values);
   return kOK;
 }
 
@@ -459,16 +586,59 @@ DB::Status RocksdbDB::ScanSingle(const std::string &table, const std::string &ke
   rocksdb::Iterator *db_iter = db_->NewIterator(rocksdb::ReadOptions());
   db_iter->Seek(key);
   for (int i = 0; db_iter->Valid() && i < len; i++) {
-    std::string data = db_iter->value().ToString();
+    rocksdb::Slice data = db_iter->value();
     result.push_back(std::vector<Field>());
-    std::vector<Field> &values = result.back();
-    if (fields != nullptr) {
-      DeserializeRowFilter(values, data, *fields);
+    codec_.Decode(data.data(), data.data() + data.size(), fields, result.back());
+    db_iter->Next();
+  }
+  delete db_iter;
+  return kOK;
+}
+
+DB::Status RocksdbDB::ScanViewSingle(const std::string &table, const std::string &key, int len,
+                                     const std::vector<std::string> *fields,
+                                     const ScanVisitor &visitor) {
+  return ScanRangeSingle(table, key, len, ScanBounds(), fields, visitor);
+}
+
+DB::Status RocksdbDB::ScanRangeSingle(const std::string &table, const std::string &key, int len,
+                                      const ScanBounds &bounds,
+                                      const std::vector<std::string> *fields,
+                                      const ScanVisitor &visitor) {
+  rocksdb::ReadOptions ropt;
+  const rocksdb::Slice end_key(bounds.end_key);
+  // lets the iterator skip files and tombstones beyond the end key
+  if (!bounds.end_key.empty()) {
+    if (bounds.reverse) {
+      ropt.iterate_lower_bound = &end_key;
     } else {
-      DeserializeRow(values, data);
-      assert(values.size() == static_cast<size_t>(fieldcount_));
+      ropt.iterate_upper_bound = &end_key;
+    }
+  }
+  rocksdb::Iterator *db_iter = db_->NewIterator(ropt);
+  std::vector<FieldView> values;
+  if (bounds.reverse) {
+    db_iter->SeekForPrev(key);
+  } else {
+    db_iter->Seek(key);
+  }
+  for (int i = 0; db_iter->Valid() && i < len; i++) {
+    // the lower bound is inclusive, but the end key is not
+    if (bounds.reverse && !bounds.end_key.empty() && db_iter->key().compare(end_key) == 0) {
+      break;
+    }
+    // the value is pinned until the iterator moves
+    rocksdb::Slice data = db_iter->value();
+    values.clear();
+    codec_.DecodeView(data.data(), data.data() + data.size(), fields, values);
+    if (!visitor(std::string_view(db_iter->key().data(), db_iter->key().size()), values)) {
+      break;
+    }
+    if (bounds.reverse) {
+      db_iter->Prev();
+    } else {
+      db_iter->Next();
     }
-    db_iter->Next();
   }
   delete db_iter;
   return kOK;
@@ -483,24 +653,62 @@ DB::Status RocksdbDB::UpdateSingle(const std::string &table, const std::string &
   } else if (!s.ok()) {
     throw utils::Exception(std::string("RocksDB Get: ") + s.ToString());
   }
-  std::vector<Field> current_values;
-  DeserializeRow(current_values, data);
-  assert(current_values.size() == static_cast<size_t>(fieldcount_));
-  for (Field &new_field : values) {
-    bool found MAYBE_UNUSED = false;
-    for (Field &cur_field : current_values) {
-      if (cur_field.name == new_field.name) {
-        found = true;
-        cur_field.value = new_field.value;
-        break;
-      }
-    }
-    assert(found);
+  std::string new_data;
+  codec_.Update(data, values, new_data);
+  s = db_->Put(wopt_, key, new_data);
+  if (!s.ok()) {
+    throw utils::Exception(std::string("RocksDB Put: ") + s.ToString());
   }
+  return kOK;
+}
 
-  data.clear();
-  SerializeRow(current_values, data);
-  s = db_->Put(wopt_, key, data);
+DB::Status RocksdbDB::ReadModifyWriteSingle(const std::string &table, const std::string &key,
+                                            const std::vector<std::string> *fields,
+                                            const RowVisitor &visitor,
+                                            std::vector<Field> &values) {
+  std::string data;
+  std::vector<FieldView> current_values;
+  std::string new_data;
+  if (txn_db_) {
+    // the record stays locked from the read to the write
+    std::unique_ptr<rocksdb::Transaction> txn(txn_db_->BeginTransaction(wopt_));
+    rocksdb::Status s = txn->GetForUpdate(rocksdb::ReadOptions(), key, &data);
+    if (s.IsNotFound()) {
+      return kNotFound;
+    } else if (s.IsBusy() || s.IsTimedOut() || s.IsTryAgain()) {
+      txn->Rollback();
+      return kAborted;
+    } else if (!s.ok()) {
+      throw utils::Exception(std::string("RocksDB GetForUpdate: ") + s.ToString());
+    }
+    codec_.DecodeView(data.data(), data.data() + data.size(), fields, current_values);
+    visitor(current_values);
+    codec_.Update(data, values, new_data);
+    s = txn->Put(key, new_data);
+    const char *what = "Put";
+    if (s.ok()) {
+      s = txn->Commit();
+      what = "Commit";
+    }
+    if (s.IsBusy() || s.IsTimedOut() || s.IsTryAgain()) {
+      // conflicts of the write are reported like the ones of the read
+      txn->Rollback();
+      return kAborted;
+    } else if (!s.ok()) {
+      throw utils::Exception(std::string("RocksDB ") + what + ": " + s.ToString());
+    }
+    return kOK;
+  }
+  rocksdb::Status s = db_->Get(rocksdb::ReadOptions(), key, &data);
+  if (s.IsNotFound()) {
+    return kNotFound;
+  } else if (!s.ok()) {
+    throw utils::Exception(std::string("RocksDB Get: ") + s.ToString());
+  }
+  codec_.DecodeView(data.data(), data.data() + data.size(), fields, current_values);
+  visitor(current_values);
+  codec_.Update(data, values, new_data);
+  s = db_->Put(wopt_, key, new_data);
   if (!s.ok()) {
     throw utils::Exception(std::string("RocksDB Put: ") + s.ToString());
   }
@@ -510,7 +718,7 @@ DB::Status RocksdbDB::UpdateSingle(const std::string &table, const std::string &
 DB::Status RocksdbDB::MergeSingle(const std::string &table, const std::string &key,
                                   std::vector<Field> &values) {
   std::string data;
-  SerializeRow(values, data);
+  codec_.Encode(values, data);
   rocksdb::Status s = db_->Merge(wopt_, key, data);
   if (!s.ok()) {
     throw utils::Exception(std::string("RocksDB Merge: ") + s.ToString());
@@ -521,7 +729,7 @@ DB::Status RocksdbDB::MergeSingle(const std::string &table, const std::string &k
 DB::Status RocksdbDB::InsertSingle(const std::string &table, const std::string &key,
                                    std::vector<Field> &values) {
   std::string data;
-  SerializeRow(values, data);
+  codec_.Encode(values, data);
   rocksdb::Status s = db_->Put(wopt_, key, data);
   if (!s.ok()) {
     throw utils::Exception(std::string("RocksDB Put: ") + s.ToString());
@@ -529,6 +737,61 @@ DB::Status RocksdbDB::InsertSingle(const std::string &table, const std::string &
   return kOK;
 }
 
+DB::Status RocksdbDB::InsertBulk(const std::string &table, const std::string &key,
+                                 std::vector<Field> &values) {
+  std::string data;
+  codec_.Encode(values, data);
+  bulk_buffer_bytes_ += key.size() + data.size();
+  bulk_buffer_.emplace_back(key, std::move(data));
+  if (bulk_buffer_bytes_ >= bulk_buffer_size_) {
+    FlushBulkBuffer();
+  }
+  return kOK;
+}
+
+void RocksdbDB::FlushBulkBuffer() {
+  if (bulk_buffer_.empty()) {
+    return;
+  }
+  // stable, so that of the records with the same key the last one inserted is kept
+  std::stable_sort(bulk_buffer_.begin(), bulk_buffer_.end(),
+                   [](const std::pair<std::string, std::string> &a,
+                      const std::pair<std::string, std::string> &b) { return a.first < b.first; });
+
+  std::string file_name;
+  {
+    const std::lock_guard<std::mutex> lock(mu_);
+    OpenDB &open_db = open_dbs_[db_path_];
+    file_name = open_db.bulk_dir + "/" + std::to_string(open_db.bulk_file_seq++) + ".sst";
+  }
+
+  rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), db_->GetOptions());
+  rocksdb::Status s = writer.Open(file_name);
+  if (!s.ok()) {
+    throw utils::Exception(std::string("RocksDB SstFileWriter Open: ") + s.ToString());
+  }
+  for (size_t i = 0; i < bulk_buffer_.size(); i++) {
+    const std::pair<std::string, std::string> &kv = bulk_buffer_[i];
+    if (i + 1 < bulk_buffer_.size() && bulk_buffer_[i + 1].first == kv.first) {
+      continue;
+    }
+    s = writer.Put(kv.first, kv.second);
+    if (!s.ok()) {
+      throw utils::Exception(std::string("RocksDB SstFileWriter Put: ") + s.ToString());
+    }
+  }
+  rocksdb::ExternalSstFileInfo info;
+  s = writer.Finish(&info);
+  if (!s.ok()) {
+    throw utils::Exception(std::string("RocksDB SstFileWriter Finish: ") + s.ToString());
+  }
+  bulk_buffer_.clear();
+  bulk_buffer_bytes_ = 0;
+
+  const std::lock_guard<std::mutex> lock(mu_);
+  open_dbs_[db_path_].bulk_files.push_back(std::move(info));
+}
+
 DB::Status RocksdbDB::DeleteSingle(const std::string &table, const std::string &key) {
   rocksdb::Status s = db_->Delete(wopt_, key);
   if (!s.ok()) {
@@ -537,6 +800,70 @@ DB::Status RocksdbDB::DeleteSingle(const std::string &table, const std::string &
   return kOK;
 }
 
+class RocksdbDB::RocksdbTransaction : public DB::Transaction {
+ public:
+  RocksdbTransaction(rocksdb::Transaction *txn) : txn_(txn) {}
+  ~RocksdbTransaction() { delete txn_; }
+
+  Status Read(const std::string &table, const std::string &key,
+              const std::vector<std::string> *fields, std::vector<Field> &result) {
+    std::string data;
+    Status st = ToStatus(txn_->GetForUpdate(rocksdb::ReadOptions(), key, &data), "GetForUpdate");
+    if (st != kOK) {
+      return st;
+    }
+    codec_.Decode(data, fields, result);
+    return kOK;
+  }
+
+  Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
+    std::string data;
+    Status st = ToStatus(txn_->GetForUpdate(rocksdb::ReadOptions(), key, &data), "GetForUpdate");
+    if (st != kOK) {
+      return st;
+    }
+    std::string new_data;
+    codec_.Update(data, values, new_data);
+    return ToStatus(txn_->Put(key, new_data), "Put");
+  }
+
+  Status Commit() {
+    return ToStatus(txn_->Commit(), "Commit");
+  }
+
+  void Rollback() {
+    txn_->Rollback();
+  }
+
+ private:
+  static Status ToStatus(const rocksdb::Status &s, const char *what) {
+    if (s.ok()) {
+      return kOK;
+    } else if (s.IsNotFound()) {
+      return kNotFound;
+    } else if (s.IsBusy() || s.IsTimedOut() || s.IsTryAgain()) {
+      // lock conflict, deadlock or failed validation of an optimistic transaction
+      return kAborted;
+    }
+    throw utils::Exception(std::string("RocksDB ") + what + ": " + s.ToString());
+  }
+
+  rocksdb::Transaction *txn_;
+};
+
+DB::Status RocksdbDB::BeginTransaction(Transaction **txn) {
+  if (txn_db_) {
+    rocksdb::TransactionOptions txn_opt;
+    txn_opt.deadlock_detect = true;
+    *txn = new RocksdbTransaction(txn_db_->BeginTransaction(wopt_, txn_opt));
+  } else if (otxn_db_) {
+    *txn = new RocksdbTransaction(otxn_db_->BeginTransaction(wopt_));
+  } else {
+    return kNotImplemented;
+  }
+  return kOK;
+}
+
 DB *NewRocksdbDB() {
   return new RocksdbDB;
 }
@@ -8,14 +8,22 @@
 #ifndef YCSB_C_ROCKSDB_DB_H_
 #define YCSB_C_ROCKSDB_DB_H_
 
+#include <map>
+#include <memory>
 #include <string>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 #include "core/db.h"
+#include "core/row_codec.h"
 #include "utils/properties.h"
 
 #include <rocksdb/db.h>
 #include <rocksdb/options.h>
+#include <rocksdb/sst_file_writer.h>
+#include <rocksdb/utilities/optimistic_transaction_db.h>
+#include <rocksdb/utilities/transaction_db.h>
 
 namespace ycsbc {
 
@@ -28,16 +36,44 @@ class RocksdbDB : public DB {
 
   void Cleanup();
 
+  void FinishLoad();
+
+  void GetStats(std::vector<Field> &stats);
+
+  std::string GetDataPath();
+
   Status Read(const std::string &table, const std::string &key,
               const std::vector<std::string> *fields, std::vector<Field> &result) {
     return (this->*(method_read_))(table, key, fields, result);
   }
 
+  Status ReadView(const std::string &table, const std::string &key,
+                  const std::vector<std::string> *fields, const RowVisitor &visitor) {
+    return (this->*(method_read_view_))(table, key, fields, visitor);
+  }
+
   Status Scan(const std::string &table, const std::string &key, int len,
               const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result) {
     return (this->*(method_scan_))(table, key, len, fields, result);
   }
 
+  Status ScanView(const std::string &table, const std::string &key, int len,
+                  const std::vector<std::string> *fields, const ScanVisitor &visitor) {
+    return (this->*(method_scan_view_))(table, key, len, fields, visitor);
+  }
+
+  Status ScanRange(const std::string &table, const std::string &key, int len,
+                   const ScanBounds &bounds, const std::vector<std::string> *fields,
+                   const ScanVisitor &visitor) {
+    return (this->*(method_scan_range_))(table, key, len, bounds, fields, visitor);
+  }
+
+  Status ReadModifyWrite(const std::string &table, const std::string &key,
+                         const std::vector<std::string> *fields, const RowVisitor &visitor,
+                         std::vector<Field> &values) {
+    return (this->*(method_read_modify_write_))(table, key, fields, visitor, values);
+  }
+
   Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
     return (this->*(method_update_))(table, key, values);
   }
@@ -50,7 +86,11 @@ class RocksdbDB : public DB {
     return (this->*(method_delete_))(table, key);
   }
 
+  Status BeginTransaction(Transaction **txn);
+
  private:
+  class RocksdbTransaction;
+
   enum RocksFormat {
     kSingleRow,
   };
@@ -58,44 +98,88 @@ class RocksdbDB : public DB {
 
   void GetOptions(const utils::Properties &props, rocksdb::Options *opt,
                   std::vector<rocksdb::ColumnFamilyDescriptor> *cf_descs);
-  static void SerializeRow(const std::vector<Field> &values, std::string &data);
-  static void DeserializeRowFilter(std::vector<Field> &values, const char *p, const char *lim,
-                                   const std::vector<std::string> &fields);
-  static void DeserializeRowFilter(std::vector<Field> &values, const std::string &data,
-                                   const std::vector<std::string> &fields);
-  static void DeserializeRow(std::vector<Field> &values, const char *p, const char *lim);
-  static void DeserializeRow(std::vector<Field> &values, const std::string &data);
 
   Status ReadSingle(const std::string &table, const std::string &key,
                     const std::vector<std::string> *fields, std::vector<Field> &result);
+  Status ReadViewSingle(const std::string &table, const std::string &key,
+                        const std::vector<std::string> *fields, const RowVisitor &visitor);
   Status ScanSingle(const std::string &table, const std::string &key, int len,
                     const std::vector<std::string> *fields,
                     std::vector<std::vector<Field>> &result);
+  Status ScanViewSingle(const std::string &table, const std::string &key, int len,
+                        const std::vector<std::string> *fields, const ScanVisitor &visitor);
+  Status ScanRangeSingle(const std::string &table, const std::string &key, int len,
+                         const ScanBounds &bounds, const std::vector<std::string> *fields,
+                         const ScanVisitor &visitor);
   Status UpdateSingle(const std::string &table, const std::string &key,
                       std::vector<Field> &values);
+  Status ReadModifyWriteSingle(const std::string &table, const std::string &key,
+                               const std::vector<std::string> *fields, const RowVisitor &visitor,
+                               std::vector<Field> &values);
   Status MergeSingle(const std::string &table, const std::string &key,
                      std::vector<Field> &values);
   Status InsertSingle(const std::string &table, const std::string &key,
                       std::vector<Field> &values);
+  Status InsertBulk(const std::string &table, const std::string &key,
+                    std::vector<Field> &values);
   Status DeleteSingle(const std::string &table, const std::string &key);
 
   Status (RocksdbDB::*method_read_)(const std::string &, const std:: string &,
                                     const std::vector<std::string> *, std::vector<Field> &);
+  Status (RocksdbDB::*method_read_view_)(const std::string &, const std::string &,
+                                         const std::vector<std::string> *, const RowVisitor &);
+  Status (RocksdbDB::*method_scan_view_)(const std::string &, const std::string &, int,
+                                         const std::vector<std::string> *, const ScanVisitor &);
+  Status (RocksdbDB::*method_scan_range_)(const std::string &, const std::string &, int,
+                                          const ScanBounds &, const std::vector<std::string> *,
+                                          const ScanVisitor &);
   Status (RocksdbDB::*method_scan_)(const std::string &, const std::string &,
                                     int, const std::vector<std::string> *,
                                     std::vector<std::vector<Field>> &);
+  Status (RocksdbDB::*method_read_modify_write_)(const std::string &, const std::string &,
+                                                 const std::vector<std::string> *,
+                                                 const RowVisitor &, std::vector<Field> &);
   Status (RocksdbDB::*method_update_)(const std::string &, const std::string &,
                                       std::vector<Field> &);
   Status (RocksdbDB::*method_insert_)(const std::string &, const std::string &,
                                       std::vector<Field> &);
   Status (RocksdbDB::*method_delete_)(const std::string &, const std::string &);
 
-  int fieldcount_;
-
-  static std::vector<rocksdb::ColumnFamilyHandle *> cf_handles_;
-  static rocksdb::DB *db_;
-  static int ref_cnt_;
+  void FlushBulkBuffer();
+
+  // sorted and written to an sst file once bulk_buffer_size_ is reached
+  std::vector<std::pair<std::string, std::string>> bulk_buffer_;
+  size_t bulk_buffer_bytes_{0};
+
+  size_t bulk_buffer_size_{0};
+
+  rocksdb::DB *db_{nullptr};
+  // set when db_ was opened as a transaction db
+  rocksdb::TransactionDB *txn_db_{nullptr};
+  rocksdb::OptimisticTransactionDB *otxn_db_{nullptr};
+  std::string db_path_;
+
+  // DBs open in this process by path, each shared by the instances on it
+  struct OpenDB {
+    rocksdb::DB *db = nullptr;
+    rocksdb::TransactionDB *txn_db = nullptr;
+    rocksdb::OptimisticTransactionDB *otxn_db = nullptr;
+    std::vector<rocksdb::ColumnFamilyHandle *> cf_handles;
+    int ref_cnt = 0;
+    std::shared_ptr<rocksdb::Statistics> statistics;
+    // block cache tickers at the previous GetStats()
+    uint64_t last_cache_hits = 0;
+    uint64_t last_cache_misses = 0;
+    // sst files of the instances bulk loading into the db, each sorted, in
+    // the order they were written
+    std::string bulk_dir;
+    std::vector<rocksdb::ExternalSstFileInfo> bulk_files;
+    int bulk_file_seq = 0;
+    int bulk_ref_cnt = 0;
+  };
+  static std::map<std::string, OpenDB> open_dbs_;
   static std::mutex mu_;
+  static RowCodec codec_;
   static rocksdb::WriteOptions wopt_;
 };
 
@@ -104,7 +104,8 @@ inline std::string BuildUpdateQuery(std::string &table, std::string &key, const
   return stmt;
 }
 
-inline std::string BuildScanQuery(std::string &table, std::string &key, const std::vector<std::string> &fields) {
+inline std::string BuildScanQuery(std::string &table, std::string &key, const std::vector<std::string> &fields,
+                                  bool reverse = false, bool bounded = false) {
   std::string stmt("SELECT ");
 
   stmt += key;
@@ -118,9 +119,17 @@ inline std::string BuildScanQuery(std::string &table, std::string &key, const st
 
   stmt += " WHERE ";
   stmt += key;
-  stmt += " >= ? ";
+  stmt += reverse ? " <= ? " : " >= ? ";
+  if (bounded) {
+    stmt += "AND ";
+    stmt += key;
+    stmt += reverse ? " > ? " : " < ? ";
+  }
   stmt += "ORDER BY ";
   stmt += key;
+  if (reverse) {
+    stmt += " DESC";
+  }
   stmt += " LIMIT ?";
 
   return stmt;
@@ -48,8 +48,7 @@ static sqlite3_stmt *SQLite3Prepare(sqlite3 *db, std::string query) {
 
 namespace ycsbc {
 
-sqlite3 *SqliteDB::db_ = nullptr;
-int SqliteDB::ref_cnt_ = 0;
+std::map<std::string, SqliteDB::OpenConn> SqliteDB::open_conns_;
 std::mutex SqliteDB::mu_;
 
 std::string SqliteDB::key_;
@@ -60,10 +59,27 @@ std::string SqliteDB::table_name_;
 void SqliteDB::Init() {
   const std::lock_guard<std::mutex> lock(mu_);
 
-  // global init
-  if (ref_cnt_++ == 0) {
+  const std::string &db_path = props_->GetProperty(PROP_DBPATH, PROP_DBPATH_DEFAULT);
+  if (db_path == "") {
+    throw utils::Exception("SQLite db path is missing");
+  }
+  // the table layout is shared by all connections, so it is only set while none is open
+  if (open_conns_.empty()) {
+    key_ = props_->GetProperty(PROP_PRIMARY_KEY, PROP_PRIMARY_KEY_DEFAULT);
+    field_prefix_ = props_->GetProperty(CoreWorkload::FIELD_NAME_PREFIX, CoreWorkload::FIELD_NAME_PREFIX_DEFAULT);
+    field_count_ = std::stoi(props_->GetProperty(CoreWorkload::FIELD_COUNT_PROPERTY, CoreWorkload::FIELD_COUNT_DEFAULT));
+    table_name_ = props_->GetProperty(CoreWorkload::TABLENAME_DEFAULT, CoreWorkload::TABLENAME_DEFAULT);
+  }
+  db_path_ = db_path;
+  open_conn_ = &open_conns_[db_path];
+
+  // per-connection init
+  if (open_conn_->ref_cnt++ == 0) {
     OpenDB();
     SetPragma();
+    open_conn_->db = db_;
+  } else {
+    db_ = open_conn_->db;
   }
 
   // per-thread init
@@ -71,21 +87,11 @@ void SqliteDB::Init() {
 }
 
 void SqliteDB::OpenDB() {
-  const std::string &db_path = props_->GetProperty(PROP_DBPATH, PROP_DBPATH_DEFAULT);
-  if (db_path == "") {
-    throw utils::Exception("SQLite db path is missing");
-  }
-
-  int rc = sqlite3_open_v2(db_path.c_str(), &db_, SQLITE_OPEN_READWRITE|SQLITE_OPEN_CREATE, nullptr);
+  int rc = sqlite3_open_v2(db_path_.c_str(), &db_, SQLITE_OPEN_READWRITE|SQLITE_OPEN_CREATE, nullptr);
   if (rc != SQLITE_OK) {
     throw utils::Exception(std::string("Init open: ") + sqlite3_errmsg(db_));
   }
 
-  key_ = props_->GetProperty(PROP_PRIMARY_KEY, PROP_PRIMARY_KEY_DEFAULT);
-  field_prefix_ = props_->GetProperty(CoreWorkload::FIELD_NAME_PREFIX, CoreWorkload::FIELD_NAME_PREFIX_DEFAULT);
-  field_count_ = std::stoi(props_->GetProperty(CoreWorkload::FIELD_COUNT_PROPERTY, CoreWorkload::FIELD_COUNT_DEFAULT));
-  table_name_ = props_->GetProperty(CoreWorkload::TABLENAME_DEFAULT, CoreWorkload::TABLENAME_DEFAULT);
-
   if (props_->GetProperty(PROP_CREATE_TABLE, PROP_CREATE_TABLE_DEFAULT) == "true") {
     std::vector<std::string> fields;
     fields.reserve(field_count_);
@@ -149,6 +155,17 @@ void SqliteDB::PrepareQueries() {
     std::string field_name = field_prefix_ + std::to_string(i);
     stmt_scan_field_[field_name] = SQLite3Prepare(db_, BuildScanQuery(table_name_, key_, {field_name}));
   }
+  for (int reverse = 0; reverse < 2; reverse++) {
+    for (int bounded = 0; bounded < 2; bounded++) {
+      stmt_scan_range_all_[reverse][bounded] =
+          SQLite3Prepare(db_, BuildScanQuery(table_name_, key_, fields, reverse, bounded));
+      for (size_t i = 0; i < field_count_; i++) {
+        std::string field_name = field_prefix_ + std::to_string(i);
+        stmt_scan_range_field_[reverse][bounded][field_name] =
+            SQLite3Prepare(db_, BuildScanQuery(table_name_, key_, {field_name}, reverse, bounded));
+      }
+    }
+  }
 
   // Update
   stmt_update_all_ = SQLite3Prepare(db_, BuildUpdateQuery(table_name_, key_, fields));
@@ -175,6 +192,17 @@ void SqliteDB::Cleanup() {
   for (auto s : stmt_scan_field_) {
     sqlite3_finalize(s.second);
   }
+  for (auto &s : stmt_scan_range_all_) {
+    sqlite3_finalize(s[0]);
+    sqlite3_finalize(s[1]);
+  }
+  for (auto &by_bounded : stmt_scan_range_field_) {
+    for (auto &by_field : by_bounded) {
+      for (auto s : by_field) {
+        sqlite3_finalize(s.second);
+      }
+    }
+  }
   sqlite3_finalize(stmt_update_all_);
   for (auto s : stmt_update_field_) {
     sqlite3_finalize(s.second);
@@ -182,14 +210,29 @@ void SqliteDB::Cleanup() {
   sqlite3_finalize(stmt_insert_);
   sqlite3_finalize(stmt_delete_);
 
-  if (--ref_cnt_ == 0) {
-    int rc = sqlite3_close(db_);
+  db_ = nullptr;
+  if (--open_conn_->ref_cnt == 0) {
+    int rc = sqlite3_close(open_conn_->db);
     assert(rc == SQLITE_OK);
+    open_conns_.erase(db_path_);
+  }
+  open_conn_ = nullptr;
+}
+
+std::shared_lock<std::shared_mutex> SqliteDB::LockConn() {
+  if (in_txn_) {
+    return std::shared_lock<std::shared_mutex>();
   }
+  return std::shared_lock<std::shared_mutex>(open_conn_->mu);
+}
+
+std::string SqliteDB::GetDataPath() {
+  return props_->GetProperty(PROP_DBPATH, PROP_DBPATH_DEFAULT);
 }
 
 DB::Status SqliteDB::Read(const std::string &table, const std::string &key,
                           const std::vector<std::string> *fields, std::vector<Field> &result) {
+  std::shared_lock<std::shared_mutex> lock = LockConn();
   DB::Status s = kOK;
   bool temp = false;
   sqlite3_stmt *stmt;
@@ -236,8 +279,61 @@ cleanup:
   return s;
 }
 
+DB::Status SqliteDB::ReadView(const std::string &table, const std::string &key,
+                              const std::vector<std::string> *fields, const RowVisitor &visitor) {
+  std::shared_lock<std::shared_mutex> lock = LockConn();
+  DB::Status s = kOK;
+  bool temp = false;
+  sqlite3_stmt *stmt;
+  size_t field_cnt;
+  std::vector<FieldView> values;
+
+  if (fields == nullptr || fields->size() == field_count_) {
+    field_cnt = field_count_;
+    stmt = stmt_read_all_;
+  } else if (fields->size() == 1) {
+    field_cnt = 1;
+    stmt = stmt_read_field_[(*fields)[0]];
+  } else {
+    temp = true;
+    field_cnt = fields->size();
+    stmt = SQLite3Prepare(db_, BuildReadQuery(table_name_, key_, *fields));
+  }
+
+  int rc = sqlite3_bind_text(stmt, 1, key.c_str(), key.size(), SQLITE_STATIC);
+  if (rc != SQLITE_OK) {
+    s = kError;
+    goto cleanup;
+  }
+
+  rc = sqlite3_step(stmt);
+  if (rc != SQLITE_ROW) {
+    s = kNotFound;
+    goto cleanup;
+  }
+
+  // the column texts stay valid until the statement is reset
+  values.reserve(field_cnt);
+  for (size_t i = 0; i < field_cnt; i++) {
+    const char *name = sqlite3_column_name(stmt, i);
+    const char *value = reinterpret_cast<const char *>(sqlite3_column_text(stmt, i));
+    values.push_back({name, std::string_view(value, sqlite3_column_bytes(stmt, i))});
+  }
+  visitor(values);
+
+cleanup:
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  if (temp) {
+    sqlite3_finalize(stmt);
+  }
+
+  return s;
+}
+
 DB::Status SqliteDB::Scan(const std::string &table, const std::string &key, int len,
                           const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result) {
+  std::shared_lock<std::shared_mutex> lock = LockConn();
   DB::Status s = kOK;
   bool temp = false;
   sqlite3_stmt *stmt;
@@ -296,7 +392,87 @@ cleanup:
   return s;
 }
 
+DB::Status SqliteDB::ScanRange(const std::string &table, const std::string &key, int len,
+                               const ScanBounds &bounds, const std::vector<std::string> *fields,
+                               const ScanVisitor &visitor) {
+  std::shared_lock<std::shared_mutex> lock = LockConn();
+  DB::Status s = kOK;
+  bool temp = false;
+  const bool bounded = !bounds.end_key.empty();
+  sqlite3_stmt *stmt;
+  size_t field_cnt;
+  int param = 1;
+  int rows = 0;
+  std::vector<FieldView> values;
+
+  if (fields == nullptr || fields->size() == field_count_) {
+    field_cnt = field_count_;
+    stmt = stmt_scan_range_all_[bounds.reverse][bounded];
+  } else if (fields->size() == 1) {
+    field_cnt = 1;
+    stmt = stmt_scan_range_field_[bounds.reverse][bounded][(*fields)[0]];
+  } else {
+    temp = true;
+    field_cnt = fields->size();
+    stmt = SQLite3Prepare(db_, BuildScanQuery(table_name_, key_, *fields, bounds.reverse, bounded));
+  }
+
+  int rc = sqlite3_bind_text(stmt, param++, key.c_str(), key.size(), SQLITE_STATIC);
+  if (rc != SQLITE_OK) {
+    s = kError;
+    goto cleanup;
+  }
+  if (bounded) {
+    rc = sqlite3_bind_text(stmt, param++, bounds.end_key.c_str(), bounds.end_key.size(),
+                           SQLITE_STATIC);
+    if (rc != SQLITE_OK) {
+      s = kError;
+      goto cleanup;
+    }
+  }
+  rc = sqlite3_bind_int(stmt, param, len);
+  if (rc != SQLITE_OK) {
+    s = kError;
+    goto cleanup;
+  }
+
+  values.reserve(field_cnt);
+  for (; rows < len; rows++) {
+    rc = sqlite3_step(stmt);
+    if (rc != SQLITE_ROW) {
+      break;
+    }
+    // the column texts stay valid until the next step
+    values.clear();
+    for (size_t i = 0; i < field_cnt; i++) {
+      const char *name = sqlite3_column_name(stmt, 1+i);
+      const char *value = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1+i));
+      values.push_back({name, std::string_view(value, sqlite3_column_bytes(stmt, 1+i))});
+    }
+    const char *row_key = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+    if (!visitor(std::string_view(row_key, sqlite3_column_bytes(stmt, 0)), values)) {
+      rows++;
+      break;
+    }
+  }
+
+  // like Scan()
+  if (rows == 0) {
+    s = kNotFound;
+  }
+
+cleanup:
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  if (temp) {
+    sqlite3_finalize(stmt);
+  }
+
+  return s;
+}
+
 DB::Status SqliteDB::Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
+  std::shared_lock<std::shared_mutex> lock = LockConn();
   DB::Status s = kOK;
   bool temp = false;
   sqlite3_stmt *stmt;
@@ -352,6 +528,7 @@ cleanup:
 
 
 DB::Status SqliteDB::Insert(const std::string &table, const std::string &key, std::vector<Field> &values) {
+  std::shared_lock<std::shared_mutex> lock = LockConn();
   DB::Status s = kOK;
   sqlite3_stmt *stmt = stmt_insert_;
 
@@ -386,6 +563,7 @@ cleanup:
 }
 
 DB::Status SqliteDB::Delete(const std::string &table, const std::string &key) {
+  std::shared_lock<std::shared_mutex> lock = LockConn();
   DB::Status s = kOK;
   sqlite3_stmt *stmt = stmt_delete_;
 
@@ -408,6 +586,59 @@ cleanup:
   return s;
 }
 
+class SqliteDB::SqliteTransaction : public DB::Transaction {
+ public:
+  SqliteTransaction(SqliteDB *db, std::unique_lock<std::shared_mutex> lock)
+      : db_(db), lock_(std::move(lock)) {
+    db_->in_txn_ = true;
+  }
+  ~SqliteTransaction() {
+    db_->in_txn_ = false;
+  }
+
+  Status Read(const std::string &table, const std::string &key,
+              const std::vector<std::string> *fields, std::vector<Field> &result) {
+    return db_->Read(table, key, fields, result);
+  }
+
+  Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
+    return db_->Update(table, key, values);
+  }
+
+  Status Commit() {
+    int rc = sqlite3_exec(db_->db_, "COMMIT", nullptr, nullptr, nullptr);
+    if (rc == SQLITE_BUSY) {
+      Rollback();
+      return kAborted;
+    } else if (rc != SQLITE_OK) {
+      throw utils::Exception(std::string("Commit: ") + sqlite3_errmsg(db_->db_));
+    }
+    return kOK;
+  }
+
+  void Rollback() {
+    sqlite3_exec(db_->db_, "ROLLBACK", nullptr, nullptr, nullptr);
+  }
+
+ private:
+  SqliteDB *db_;
+  std::unique_lock<std::shared_mutex> lock_;
+};
+
+DB::Status SqliteDB::BeginTransaction(Transaction **txn) {
+  // the connection is shared by all threads on it, so while a transaction is
+  // open no other operation may run on it
+  std::unique_lock<std::shared_mutex> lock(open_conn_->mu);
+  int rc = sqlite3_exec(db_, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr);
+  if (rc == SQLITE_BUSY) {
+    return kAborted;
+  } else if (rc != SQLITE_OK) {
+    throw utils::Exception(std::string("BeginTransaction: ") + sqlite3_errmsg(db_));
+  }
+  *txn = new SqliteTransaction(this, std::move(lock));
+  return kOK;
+}
+
 DB *NewSqliteDB() {
   return new SqliteDB;
 }
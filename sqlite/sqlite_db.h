@@ -8,7 +8,9 @@
 #ifndef YCSB_C_SQLITE_DB_H_
 #define YCSB_C_SQLITE_DB_H_
 
+#include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 #include "core/db.h"
@@ -26,27 +28,63 @@ class SqliteDB : public DB {
 
   void Cleanup();
 
+  std::string GetDataPath();
+
   Status Read(const std::string &table, const std::string &key,
               const std::vector<std::string> *fields, std::vector<Field> &result);
 
+  Status ReadView(const std::string &table, const std::string &key,
+                  const std::vector<std::string> *fields, const RowVisitor &visitor);
+
   Status Scan(const std::string &table, const std::string &key, int len,
               const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result);
 
+  Status ScanView(const std::string &table, const std::string &key, int len,
+                  const std::vector<std::string> *fields, const ScanVisitor &visitor) {
+    return ScanRange(table, key, len, ScanBounds(), fields, visitor);
+  }
+
+  Status ScanRange(const std::string &table, const std::string &key, int len,
+                   const ScanBounds &bounds, const std::vector<std::string> *fields,
+                   const ScanVisitor &visitor);
+
   Status Update(const std::string &table, const std::string &key, std::vector<Field> &values);
 
   Status Insert(const std::string &table, const std::string &key, std::vector<Field> &values);
 
   Status Delete(const std::string &table, const std::string &key);
 
+  Status BeginTransaction(Transaction **txn);
+
  private:
+  class SqliteTransaction;
+
   void OpenDB();
   void SetPragma();
   void PrepareQueries();
-
-  static sqlite3 *db_;
-  static int ref_cnt_;
+  ///
+  /// Locks the connection for an operation outside of a transaction, or
+  /// returns an empty lock if this instance has a transaction open.
+  ///
+  std::shared_lock<std::shared_mutex> LockConn();
+
+  // connections open in this process by path, each shared by the instances on it
+  struct OpenConn {
+    sqlite3 *db = nullptr;
+    int ref_cnt = 0;
+    // shared by operations, held exclusively by an open transaction so that
+    // no operation of another thread runs inside of it
+    std::shared_mutex mu;
+  };
+  static std::map<std::string, OpenConn> open_conns_;
   static std::mutex mu_;
 
+  sqlite3 *db_{nullptr};
+  OpenConn *open_conn_{nullptr};
+  std::string db_path_;
+  // whether this instance holds the connection for a transaction
+  bool in_txn_{false};
+
   static std::string key_;
   static std::string field_prefix_;
   static size_t field_count_;
@@ -54,11 +92,15 @@ class SqliteDB : public DB {
 
   sqlite3_stmt *stmt_read_all_;
   sqlite3_stmt *stmt_scan_all_;
+  // all fields, indexed by reverse and bounded
+  sqlite3_stmt *stmt_scan_range_all_[2][2];
   sqlite3_stmt *stmt_update_all_;
   sqlite3_stmt *stmt_insert_;
   sqlite3_stmt *stmt_delete_;
   std::unordered_map<std::string, sqlite3_stmt *> stmt_read_field_;
   std::unordered_map<std::string, sqlite3_stmt *> stmt_scan_field_;
+  // single field, indexed by reverse and bounded
+  std::unordered_map<std::string, sqlite3_stmt *> stmt_scan_range_field_[2][2];
   std::unordered_map<std::string, sqlite3_stmt *> stmt_update_field_;
 };
 
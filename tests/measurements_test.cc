@@ -0,0 +1,96 @@
+//
+//  measurements_test.cc
+//  YCSB-cpp
+//
+
+#include "core/measurements.h"
+
+#include <iostream>
+#include <thread>
+
+namespace {
+  int failures = 0;
+
+  void Expect(bool condition, const char *what) {
+    if (!condition) {
+      std::cerr << "FAILED: " << what << std::endl;
+      failures++;
+    }
+  }
+
+  void TestShardReuse() {
+    ycsbc::ThreadShards<uint64_t> shards;
+    // like the load and then the run threads
+    for (int phase = 0; phase < 2; phase++) {
+      std::thread a([&shards] { shards.Local() += 1; });
+      a.join();
+      std::thread b([&shards] { shards.Local() += 2; });
+      b.join();
+    }
+    size_t count = 0;
+    uint64_t sum = 0;
+    shards.ForEach([&](uint64_t &shard) {
+      count++;
+      sum += shard;
+    });
+    Expect(count == 1, "threads that exited hand their shard on");
+    Expect(sum == 6, "a reused shard keeps what was recorded");
+  }
+
+#ifdef HDRMEASUREMENT
+  hdr_histogram *NewHistogram() {
+    hdr_histogram *histogram;
+    hdr_init(10, 100LL * 1000 * 1000 * 1000, 3, &histogram);
+    return histogram;
+  }
+
+  void TestSubtractEmpty() {
+    hdr_histogram *last = NewHistogram();
+    hdr_histogram *merged = NewHistogram();
+    hdr_histogram *interval = NewHistogram();
+    hdr_record_values(merged, 1000, 3);
+    hdr_record_value(merged, 2000000);
+    ycsbc::SubtractHistogram(interval, merged, last);
+    Expect(interval->total_count == 4, "first interval holds all values");
+    Expect(hdr_values_are_equivalent(interval, hdr_max(interval), 2000000),
+           "first interval keeps its maximum");
+    hdr_close(last);
+    hdr_close(merged);
+    hdr_close(interval);
+  }
+
+  void TestSubtractNewMaximum() {
+    hdr_histogram *last = NewHistogram();
+    hdr_histogram *merged = NewHistogram();
+    hdr_histogram *interval = NewHistogram();
+    // previous intervals
+    hdr_record_values(last, 1000, 5);
+    hdr_record_values(merged, 1000, 5);
+    // a spike larger than anything recorded before, and a repeated value
+    hdr_record_value(merged, 5000000);
+    hdr_record_value(merged, 1000);
+    ycsbc::SubtractHistogram(interval, merged, last);
+    Expect(interval->total_count == 2, "interval holds the new values");
+    Expect(hdr_values_are_equivalent(interval, hdr_max(interval), 5000000),
+           "interval keeps a value above the previous maximum");
+    Expect(hdr_values_are_equivalent(interval, hdr_min(interval), 1000),
+           "interval keeps a value in an old bucket");
+    hdr_close(last);
+    hdr_close(merged);
+    hdr_close(interval);
+  }
+#endif
+} // anonymous
+
+int main() {
+  TestShardReuse();
+#ifdef HDRMEASUREMENT
+  TestSubtractEmpty();
+  TestSubtractNewMaximum();
+#endif
+  if (failures > 0) {
+    return 1;
+  }
+  std::cout << "measurements_test passed" << std::endl;
+  return 0;
+}
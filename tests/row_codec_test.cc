@@ -0,0 +1,141 @@
+//
+//  row_codec_test.cc
+//  YCSB-cpp
+//
+
+#include "core/row_codec.h"
+#include "utils/utils.h"
+
+#include <iostream>
+
+namespace {
+  int failures = 0;
+
+  void Expect(bool condition, const char *what) {
+    if (!condition) {
+      std::cerr << "FAILED: " << what << std::endl;
+      failures++;
+    }
+  }
+
+  ycsbc::RowCodec MakeCodec(bool varint_lengths) {
+    ycsbc::utils::Properties props;
+    props.SetProperty("fieldcount", "4");
+    props.SetProperty("row.varintlengths", varint_lengths ? "true" : "false");
+    return ycsbc::RowCodec(props);
+  }
+
+  std::vector<ycsbc::DB::Field> AllFields() {
+    return {{"field0", "a"}, {"field1", ""}, {"field2", "ccc"}, {"field3", "dddd"}};
+  }
+
+  bool Equal(const std::vector<ycsbc::DB::Field> &a, const std::vector<ycsbc::DB::Field> &b) {
+    if (a.size() != b.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+      if (a[i].name != b[i].name || a[i].value != b[i].value) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void TestRoundTrip(bool varint_lengths) {
+    const ycsbc::RowCodec codec = MakeCodec(varint_lengths);
+    std::string data;
+    codec.Encode(AllFields(), data);
+    std::vector<ycsbc::DB::Field> values;
+    codec.Decode(data, nullptr, values);
+    Expect(Equal(values, AllFields()), "all fields decode as encoded");
+
+    const std::vector<std::string> fields = {"field3", "field1"};
+    values.clear();
+    codec.Decode(data, &fields, values);
+    Expect(Equal(values, {{"field3", "dddd"}, {"field1", ""}}), "listed fields decode in order");
+
+    std::vector<ycsbc::DB::FieldView> views;
+    codec.DecodeView(data.data(), data.data() + data.size(), &fields, views);
+    Expect(views.size() == 2 && views[0].name == "field3" && views[0].value == "dddd" &&
+           views[1].name == "field1" && views[1].value.empty(),
+           "views point at the listed fields");
+  }
+
+  void TestSparse(bool varint_lengths) {
+    const ycsbc::RowCodec codec = MakeCodec(varint_lengths);
+    const std::vector<ycsbc::DB::Field> sparse = {{"field2", "x"}, {"field0", "yy"}};
+    std::string data;
+    codec.Encode(sparse, data);
+    std::vector<ycsbc::DB::Field> values;
+    codec.Decode(data, nullptr, values);
+    Expect(Equal(values, sparse), "a sparse row keeps its fields and their order");
+
+    const std::vector<std::string> fields = {"field1", "field0"};
+    values.clear();
+    codec.Decode(data, &fields, values);
+    Expect(Equal(values, {{"field0", "yy"}}), "missing fields of a sparse row are skipped");
+  }
+
+  void TestUpdate(bool varint_lengths) {
+    const ycsbc::RowCodec codec = MakeCodec(varint_lengths);
+    std::string row;
+    codec.Encode({{"field0", "a"}, {"field2", "ccc"}}, row);
+    std::string updated;
+    codec.Update(row, {{"field2", "zz"}, {"field3", "new"}}, updated);
+    std::vector<ycsbc::DB::Field> values;
+    codec.Decode(updated, nullptr, values);
+    Expect(Equal(values, {{"field0", "a"}, {"field2", "zz"}, {"field3", "new"}}),
+           "an update replaces fields in place and appends new ones");
+
+    std::string full;
+    codec.Encode(AllFields(), full);
+    updated.clear();
+    codec.Update(full, {{"field1", "b"}}, updated);
+    values.clear();
+    codec.Decode(updated, nullptr, values);
+    std::vector<ycsbc::DB::Field> expected = AllFields();
+    expected[1].value = "b";
+    Expect(Equal(values, expected), "an update of a dense row keeps it dense and in order");
+  }
+
+  void TestCorruptFieldIndex() {
+    const ycsbc::RowCodec codec = MakeCodec(false);
+    ycsbc::utils::Properties props;
+    props.SetProperty("fieldcount", "8");
+    const ycsbc::RowCodec wider(props);
+    // field7 is beyond the four fields of codec
+    std::string data;
+    wider.Encode({{"field7", "v"}}, data);
+    bool thrown = false;
+    try {
+      std::vector<ycsbc::DB::Field> values;
+      codec.Decode(data, nullptr, values);
+    } catch (const ycsbc::utils::Exception &) {
+      thrown = true;
+    }
+    Expect(thrown, "a field index beyond the field count is rejected");
+
+    thrown = false;
+    try {
+      std::string updated;
+      codec.Update(data, {{"field0", "a"}}, updated);
+    } catch (const ycsbc::utils::Exception &) {
+      thrown = true;
+    }
+    Expect(thrown, "an update of a row with an unknown field index is rejected");
+  }
+} // anonymous
+
+int main() {
+  for (bool varint_lengths : {false, true}) {
+    TestRoundTrip(varint_lengths);
+    TestSparse(varint_lengths);
+    TestUpdate(varint_lengths);
+  }
+  TestCorruptFieldIndex();
+  if (failures > 0) {
+    return 1;
+  }
+  std::cout << "row_codec_test passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,157 @@
+//
+//  perf_counters.h
+//  YCSB-cpp
+//
+
+#ifndef YCSB_C_PERF_COUNTERS_H_
+#define YCSB_C_PERF_COUNTERS_H_
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ycsbc {
+
+namespace utils {
+
+enum PerfCounter {
+  PERF_CYCLES = 0,
+  PERF_INSTRUCTIONS,
+  PERF_LLC_MISSES,
+  PERF_BRANCH_MISSES,
+  // software counters, available where hardware counters are not
+  PERF_TASK_CLOCK,
+  PERF_PAGE_FAULTS,
+  PERF_CONTEXT_SWITCHES,
+  MAXPERFCOUNTER
+};
+
+const char *const kPerfCounterString[MAXPERFCOUNTER] = {
+  "Cycles",
+  "Instructions",
+  "LLCMisses",
+  "BranchMisses",
+  "TaskClock(ns)",
+  "PageFaults",
+  "ContextSwitches"
+};
+
+///
+/// Performance counters of the calling thread, opened with perf_event_open.
+/// Counters that are not supported or not permitted stay unavailable.
+/// The software counters include kernel mode, the hardware counters only if
+/// hardware_kernel is set, which usually needs a lower perf_event_paranoid.
+///
+class PerfCounters {
+ public:
+  explicit PerfCounters(bool hardware_kernel = false) {
+    for (int c = 0; c < MAXPERFCOUNTER; c++) {
+      fd_[c] = -1;
+    }
+#if defined(__linux__)
+    const struct {
+      uint32_t type;
+      uint64_t config;
+    } events[MAXPERFCOUNTER] = {
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+      {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+      {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+      {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    };
+    for (int c = 0; c < MAXPERFCOUNTER; c++) {
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = events[c].type;
+      attr.config = events[c].config;
+      attr.disabled = 1;
+      // context switches and page faults are counted in kernel mode
+      attr.exclude_kernel = events[c].type == PERF_TYPE_HARDWARE && !hardware_kernel;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      fd_[c] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+  }
+
+  ~PerfCounters() {
+#if defined(__linux__)
+    for (int c = 0; c < MAXPERFCOUNTER; c++) {
+      if (fd_[c] >= 0) {
+        close(fd_[c]);
+      }
+    }
+#endif
+  }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  bool Available(PerfCounter c) const { return fd_[c] >= 0; }
+
+  ///
+  /// Whether any of the hardware counters could be opened.
+  ///
+  bool HardwareAvailable() const {
+    return Available(PERF_CYCLES) || Available(PERF_INSTRUCTIONS) ||
+           Available(PERF_LLC_MISSES) || Available(PERF_BRANCH_MISSES);
+  }
+
+  void Start() {
+#if defined(__linux__)
+    for (int c = 0; c < MAXPERFCOUNTER; c++) {
+      if (fd_[c] >= 0) {
+        ioctl(fd_[c], PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_[c], PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+  }
+
+  void Stop() {
+#if defined(__linux__)
+    for (int c = 0; c < MAXPERFCOUNTER; c++) {
+      if (fd_[c] >= 0) {
+        ioctl(fd_[c], PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+#endif
+  }
+
+  ///
+  /// Returns the count since Start(), scaled up if the counter was
+  /// multiplexed with other events.
+  ///
+  uint64_t Read(PerfCounter c) const {
+#if defined(__linux__)
+    uint64_t data[3]; // value, time enabled, time running
+    if (fd_[c] < 0 || read(fd_[c], data, sizeof(data)) != sizeof(data) || data[2] == 0) {
+      return 0;
+    }
+    if (data[2] < data[1]) {
+      return static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]);
+    }
+    return data[0];
+#else
+    return 0;
+#endif
+  }
+
+ private:
+  int fd_[MAXPERFCOUNTER];
+};
+
+} // utils
+
+} // ycsbc
+
+#endif // YCSB_C_PERF_COUNTERS_H_
@@ -11,6 +11,8 @@
 
 #include <string>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <fstream>
 #include <cassert>
 
@@ -22,24 +24,39 @@ namespace utils {
 
 class Properties {
  public:
+  Properties() : read_(std::make_shared<ReadValues>()) {}
+
   std::string GetProperty(const std::string &key,
                           const std::string &default_value = std::string()) const;
   const std::string &operator[](const std::string &key) const;
   void SetProperty(const std::string &key, const std::string &value);
   bool ContainsKey(const std::string &key) const;
+  const std::map<std::string, std::string> &properties() const { return properties_; }
   void Load(std::ifstream &input);
+  ///
+  /// Returns the configuration the run actually used: every property looked
+  /// up through GetProperty, on this object or a copy of it, with the value
+  /// it resolved to, defaults included, and the properties set on this object.
+  ///
+  std::map<std::string, std::string> EffectiveProperties() const;
  private:
+  // values returned by GetProperty, shared with the copies
+  struct ReadValues {
+    std::mutex mu;
+    std::map<std::string, std::string> values;
+  };
+
   std::map<std::string, std::string> properties_;
+  std::shared_ptr<ReadValues> read_;
 };
 
 inline std::string Properties::GetProperty(const std::string &key,
                                            const std::string &default_value) const {
   std::map<std::string, std::string>::const_iterator it = properties_.find(key);
-  if (properties_.end() == it) {
-    return default_value;
-  } else {
-    return it->second;
-  }
+  const std::string &value = properties_.end() == it ? default_value : it->second;
+  std::lock_guard<std::mutex> lock(read_->mu);
+  read_->values[key] = value;
+  return value;
 }
 
 inline const std::string &Properties::operator[](const std::string &key) const {
@@ -54,6 +71,18 @@ inline bool Properties::ContainsKey(const std::string &key) const {
   return properties_.find(key) != properties_.end();
 }
 
+inline std::map<std::string, std::string> Properties::EffectiveProperties() const {
+  std::map<std::string, std::string> effective;
+  {
+    std::lock_guard<std::mutex> lock(read_->mu);
+    effective = read_->values;
+  }
+  for (const auto &p : properties_) {
+    effective[p.first] = p.second;
+  }
+  return effective;
+}
+
 inline void Properties::Load(std::ifstream &input) {
   if (!input.is_open()) {
     throw Exception("File not open!");
@@ -0,0 +1,130 @@
+//
+//  resource_usage.h
+//  YCSB-cpp
+//
+
+#ifndef YCSB_C_RESOURCE_USAGE_H_
+#define YCSB_C_RESOURCE_USAGE_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if !defined(_MSC_VER)
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+namespace ycsbc {
+
+namespace utils {
+
+///
+/// CPU time, memory, context switches and storage I/O of the process, from
+/// getrusage(), /proc/self/status and /proc/self/io where available.
+///
+struct ResourceUsage {
+  double user_time = 0;       // seconds
+  double system_time = 0;     // seconds
+  uint64_t rss = 0;           // bytes
+  uint64_t peak_rss = 0;      // bytes
+  uint64_t voluntary_cs = 0;
+  uint64_t involuntary_cs = 0;
+  // bytes the process caused to be read from and written to storage
+  uint64_t io_read_bytes = 0;
+  uint64_t io_write_bytes = 0;
+
+  static ResourceUsage Sample() {
+    ResourceUsage usage;
+#if !defined(_MSC_VER)
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+      usage.user_time = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6;
+      usage.system_time = ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+      usage.voluntary_cs = ru.ru_nvcsw;
+      usage.involuntary_cs = ru.ru_nivcsw;
+#if defined(__APPLE__)
+      usage.peak_rss = ru.ru_maxrss;
+#else
+      usage.peak_rss = static_cast<uint64_t>(ru.ru_maxrss) * 1024;
+#endif
+    }
+#endif
+#if defined(__linux__)
+    // getrusage() has no current rss
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+      std::istringstream fields(line);
+      std::string name;
+      uint64_t kb;
+      if (!(fields >> name >> kb)) {
+        continue;
+      }
+      if (name == "VmRSS:") {
+        usage.rss = kb * 1024;
+      } else if (name == "VmHWM:") {
+        usage.peak_rss = kb * 1024;
+      }
+    }
+    std::ifstream io("/proc/self/io");
+    while (std::getline(io, line)) {
+      std::istringstream fields(line);
+      std::string name;
+      uint64_t bytes;
+      if (!(fields >> name >> bytes)) {
+        continue;
+      }
+      if (name == "read_bytes:") {
+        usage.io_read_bytes = bytes;
+      } else if (name == "write_bytes:") {
+        usage.io_write_bytes = bytes;
+      }
+    }
+#endif
+    return usage;
+  }
+
+  ///
+  /// Returns the CPU time, context switches and I/O since an earlier sample,
+  /// with the memory usage of this sample.
+  ///
+  ResourceUsage Since(const ResourceUsage &earlier) const {
+    ResourceUsage diff = *this;
+    diff.user_time -= earlier.user_time;
+    diff.system_time -= earlier.system_time;
+    diff.voluntary_cs -= earlier.voluntary_cs;
+    diff.involuntary_cs -= earlier.involuntary_cs;
+    diff.io_read_bytes -= earlier.io_read_bytes;
+    diff.io_write_bytes -= earlier.io_write_bytes;
+    return diff;
+  }
+};
+
+///
+/// Returns the size of a file, or the total size of the files under a
+/// directory, or 0 if the path does not exist.
+///
+inline uint64_t DiskUsage(const std::string &path) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  if (fs::is_regular_file(path, ec)) {
+    return fs::file_size(path, ec);
+  }
+  uint64_t size = 0;
+  for (fs::recursive_directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+    // files removed during the walk are skipped
+    std::error_code file_ec;
+    uint64_t file_size = it->is_regular_file(file_ec) ? it->file_size(file_ec) : 0;
+    size += file_ec ? 0 : file_size;
+  }
+  return size;
+}
+
+} // utils
+
+} // ycsbc
+
+#endif // YCSB_C_RESOURCE_USAGE_H_
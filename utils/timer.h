@@ -10,6 +10,13 @@
 #define YCSB_C_TIMER_H_
 
 #include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
 
 namespace ycsbc {
 
@@ -36,6 +43,130 @@ class Timer {
   Clock::time_point time_;
 };
 
+///
+/// Reads the time stamp counter, which is converted to nanoseconds with a
+/// rate calibrated against steady_clock.
+///
+class TscClock {
+ public:
+  ///
+  /// Whether the CPU has an invariant TSC, which ticks at a constant rate
+  /// regardless of frequency scaling and is synchronized across cores.
+  ///
+  static bool Available() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+      return false;
+    }
+    return edx & (1 << 8);
+#else
+    return false;
+#endif
+  }
+
+  static uint64_t Ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+  }
+
+  static void Calibrate() {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point t0 = Clock::now();
+    uint64_t c0 = Ticks();
+    Clock::time_point t1;
+    do {
+      t1 = Clock::now();
+    } while (t1 - t0 < std::chrono::milliseconds(50));
+    uint64_t c1 = Ticks();
+    nanos_per_tick_ = std::chrono::duration<double, std::nano>(t1 - t0).count() / (c1 - c0);
+  }
+
+  static uint64_t ToNanos(uint64_t ticks) {
+    return static_cast<uint64_t>(ticks * nanos_per_tick_);
+  }
+
+  static double nanos_per_tick() { return nanos_per_tick_; }
+
+ private:
+  static inline double nanos_per_tick_ = 1.0;
+};
+
+///
+/// Nanosecond timer for operation latencies. Reads the TSC once EnableTsc()
+/// succeeded, steady_clock otherwise.
+///
+class LatencyTimer {
+ public:
+  void Start() {
+    start_ = Now();
+  }
+
+  uint64_t End() {
+    uint64_t elapsed = Now() - start_;
+    return use_tsc_ ? TscClock::ToNanos(elapsed) : elapsed;
+  }
+
+  ///
+  /// Switches all latency timers to the TSC. Must be called before any timer
+  /// is started.
+  ///
+  /// @return false if the CPU has no invariant TSC.
+  ///
+  static bool EnableTsc() {
+    if (!TscClock::Available()) {
+      return false;
+    }
+    TscClock::Calibrate();
+    use_tsc_ = true;
+    return true;
+  }
+
+  ///
+  /// Prints the clock source with the overhead of a Start()/End() pair and
+  /// the smallest non-zero interval observed between two clock reads.
+  ///
+  static void SelfTest(std::ostream &os) {
+    const int kRounds = 1000000;
+    LatencyTimer timer;
+    uint64_t sum = 0;
+    for (int i = 0; i < kRounds; i++) {
+      timer.Start();
+      sum += timer.End();
+    }
+    uint64_t resolution = UINT64_MAX;
+    for (int i = 0; i < kRounds; i++) {
+      uint64_t t0 = Now();
+      uint64_t t1 = Now();
+      if (t1 > t0 && t1 - t0 < resolution) {
+        resolution = t1 - t0;
+      }
+    }
+    double resolution_ns = use_tsc_ ? resolution * TscClock::nanos_per_tick() : resolution;
+    os << "Timer: " << (use_tsc_ ? "tsc" : "steady_clock");
+    if (use_tsc_) {
+      os << " (" << 1.0 / TscClock::nanos_per_tick() << " ticks/ns)";
+    }
+    os << ", overhead(ns): " << static_cast<double>(sum) / kRounds
+       << ", resolution(ns): " << resolution_ns << std::endl;
+  }
+
+ private:
+  static uint64_t Now() {
+    if (use_tsc_) {
+      return TscClock::Ticks();
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  static inline bool use_tsc_ = false;
+  uint64_t start_{0};
+};
+
 } // utils
 
 } // ycsbc
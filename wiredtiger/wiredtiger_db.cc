@@ -45,6 +45,9 @@ namespace {
   const std::string PROP_IN_MEMORY = WT_PREFIX ".in_memory";
   const std::string PROP_IN_MEMORY_DEFAULT = "false";
 
+  const std::string PROP_STATISTICS = WT_PREFIX ".statistics";
+  const std::string PROP_STATISTICS_DEFAULT = "";
+
   const std::string PROP_LSM_MGR_MERGE = WT_PREFIX ".lsm_mgr.merge";
   const std::string PROP_LSM_MGR_MERGE_DEFAULT = "true";
 
@@ -84,8 +87,7 @@ namespace {
 
 namespace ycsbc {
 
-WT_CONNECTION* WTDB::conn_ = nullptr;
-int WTDB::ref_cnt_ = 0;
+std::map<std::string, WTDB::OpenConn> WTDB::open_conns_;
 std::mutex WTDB::mu_;
 
 void WTDB::Init(){
@@ -93,33 +95,38 @@ void WTDB::Init(){
 
   const utils::Properties &props = *props_;
   const std::string &format = props.GetProperty(PROP_FORMAT, PROP_FORMAT_DEFAULT);
-  fieldcount_ = std::stoi(props.GetProperty(CoreWorkload::FIELD_COUNT_PROPERTY,
-                                            CoreWorkload::FIELD_COUNT_DEFAULT));
+  codec_ = RowCodec(props);
 
   if(format=="single"){
     method_read_ = &WTDB::ReadSingleEntry;
+    method_read_view_ = &WTDB::ReadViewSingleEntry;
     method_scan_ = &WTDB::ScanSingleEntry;
+    method_scan_view_ = &WTDB::ScanViewSingleEntry;
+    method_scan_range_ = &WTDB::ScanRangeSingleEntry;
     method_update_ = &WTDB::UpdateSingleEntry;
+    method_read_modify_write_ = &WTDB::ReadModifyWriteSingleEntry;
     method_insert_ = &WTDB::InsertSingleEntry;
     method_delete_ = &WTDB::DeleteSingleEntry;
   } else {
     throw utils::Exception("single ONLY");
   }
 
-  ref_cnt_++;
-  if(conn_){
+  const std::string &home = props.GetProperty(PROP_HOME, PROP_HOME_DEFAULT);
+  if(home.empty()){
+    throw utils::Exception(WT_PREFIX " home is missing");
+  }
+  home_ = home;
+  OpenConn &open_conn = open_conns_[home];
+  if(open_conn.ref_cnt++){
+    conn_ = open_conn.conn;
     error_check(conn_->open_session(conn_, NULL, NULL, &session_));
     error_check(session_->open_cursor(session_, "table:ycsbc", NULL, "overwrite=true", &cursor_));
     return;
   }
 
-  // Open connection (once, per process)
+  // Open connection (once per home)
   {
     // 1. Setup wiredtiger home directory
-    const std::string &home = props.GetProperty(PROP_HOME, PROP_HOME_DEFAULT);
-    if(home.empty()){
-      throw utils::Exception(WT_PREFIX " home is missing");
-    }
     int ret = mkdir(home.c_str(), 0775);
     if (ret && errno != EEXIST) {
         throw utils::Exception(std::string("Init mkdir: ") + strerror(errno));
@@ -134,6 +141,8 @@ void WTDB::Init(){
       if(!cache_size.empty()) db_config += "cache_size="+ cache_size+ ",";
       if(!direct_io.empty())  db_config += "direct_io=" + direct_io + ",";
       if(!in_memory.empty())  db_config += "in_memory=" + in_memory + ",";
+      const std::string &statistics = props.GetProperty(PROP_STATISTICS, PROP_STATISTICS_DEFAULT);
+      if(!statistics.empty()) db_config += "statistics=(" + statistics + "),";
     }
     { // 2.2 LSM Manager
       std::string lsm_config;
@@ -147,6 +156,7 @@ void WTDB::Init(){
     // db_config += ",block_cache=(enabled=true,hashsize=10K,size=300MB,system_ram=300MB,type=DRAM)";
     std::cout<<"db config: "<<db_config<<std::endl;
     error_check(wiredtiger_open(home.c_str(), NULL, db_config.c_str(), &conn_));
+    open_conn.conn = conn_;
   }
 
   // Open session (per thread)
@@ -198,10 +208,53 @@ void WTDB::Cleanup(){
   const std::lock_guard<std::mutex> lock(mu_);
   cursor_->close(cursor_);
   error_check(session_->close(session_, NULL));
-  if (--ref_cnt_) {
+  conn_ = nullptr;
+  OpenConn &open_conn = open_conns_[home_];
+  if (--open_conn.ref_cnt) {
+    return;
+  }
+  error_check(open_conn.conn->close(open_conn.conn, NULL));
+  open_conns_.erase(home_);
+}
+
+void WTDB::GetStats(std::vector<Field> &stats){
+  const std::lock_guard<std::mutex> lock(mu_);
+  if(conn_ == nullptr){
     return;
   }
-  error_check(conn_->close(conn_, NULL));
+  // sessions are single threaded, so the status thread opens its own
+  WT_SESSION *session;
+  error_check(conn_->open_session(conn_, NULL, NULL, &session));
+  WT_CURSOR *cursor;
+  // fails unless the connection was opened with statistics enabled
+  if(session->open_cursor(session, "statistics:", NULL, NULL, &cursor) == 0){
+    const int keys[] = {
+      WT_STAT_CONN_CACHE_BYTES_INUSE,
+      WT_STAT_CONN_CACHE_BYTES_DIRTY,
+      WT_STAT_CONN_CACHE_BYTES_MAX,
+      WT_STAT_CONN_CACHE_BYTES_READ,
+      WT_STAT_CONN_CACHE_BYTES_WRITE,
+      WT_STAT_CONN_CACHE_READ,
+      WT_STAT_CONN_CACHE_EVICTION_DIRTY,
+      WT_STAT_CONN_TXN_COMMIT,
+      WT_STAT_CONN_TXN_ROLLBACK,
+      WT_STAT_CONN_TXN_CHECKPOINT_RUNNING,
+    };
+    for(int key : keys){
+      cursor->set_key(cursor, key);
+      if(cursor->search(cursor) != 0) continue;
+      const char *desc, *pvalue;
+      int64_t value;
+      error_check(cursor->get_value(cursor, &desc, &pvalue, &value));
+      stats.push_back({desc, std::to_string(value)});
+    }
+    cursor->close(cursor);
+  }
+  error_check(session->close(session, NULL));
+}
+
+std::string WTDB::GetDataPath(){
+  return props_->GetProperty(PROP_HOME, PROP_HOME_DEFAULT);
 }
 
 DB::Status WTDB::ReadSingleEntry(const std::string &table, const std::string &key,
@@ -214,15 +267,39 @@ DB::Status WTDB::ReadSingleEntry(const std::string &table, const std::string &ke
   ret = cursor_->search(cursor_);
   if(ret==WT_NOTFOUND){
     return kNotFound;
+  } else if(ret==WT_ROLLBACK){
+    return kAborted;
   } else if(ret != 0) {
     throw utils::Exception(WT_PREFIX " search error");
   }
   error_check(cursor_->get_value(cursor_, &v));
-  if (fields != nullptr) {
-    DeserializeRowFilter(&result, (const char*)v.data, v.size, *fields);
-  } else {
-    DeserializeRow(&result, (const char*)v.data, v.size);
+  const char *data = static_cast<const char *>(v.data);
+  codec_.Decode(data, data + v.size, fields, result);
+  return kOK;
+}
+
+DB::Status WTDB::ReadViewSingleEntry(const std::string &table, const std::string &key,
+                                     const std::vector<std::string> *fields,
+                                     const RowVisitor &visitor) {
+  WT_ITEM k = {key.data(), key.size()};
+  WT_ITEM v;
+  int ret;
+  cursor_->set_key(cursor_, &k);
+  ret = cursor_->search(cursor_);
+  if(ret==WT_NOTFOUND){
+    return kNotFound;
+  } else if(ret==WT_ROLLBACK){
+    return kAborted;
+  } else if(ret != 0) {
+    throw utils::Exception(WT_PREFIX " search error");
   }
+  // v points into the page the cursor is positioned on, valid until the
+  // cursor is used again
+  error_check(cursor_->get_value(cursor_, &v));
+  std::vector<FieldView> values;
+  const char *data = static_cast<const char *>(v.data);
+  codec_.DecodeView(data, data + v.size, fields, values);
+  visitor(values);
   return kOK;
 }
 
@@ -240,19 +317,60 @@ DB::Status WTDB::ScanSingleEntry(const std::string &table, const std::string &ke
   }
   for(int i=0; !ret && i<len; ++i){
     error_check(cursor_->get_value(cursor_, &v));
+    const char *data = static_cast<const char *>(v.data);
     result.emplace_back(std::vector<Field>());
-    if (fields != nullptr) {
-      DeserializeRowFilter(&result.back(), (const char*)v.data, v.size, *fields);
-    } else {
-      DeserializeRow(&result.back(), (const char*)v.data, v.size);
+    codec_.Decode(data, data + v.size, fields, result.back());
+    ret = cursor_->next(cursor_);
+  }
+  return kOK;
+}
+
+DB::Status WTDB::ScanViewSingleEntry(const std::string &table, const std::string &key, int len,
+                                     const std::vector<std::string> *fields,
+                                     const ScanVisitor &visitor) {
+  return ScanRangeSingleEntry(table, key, len, ScanBounds(), fields, visitor);
+}
+
+DB::Status WTDB::ScanRangeSingleEntry(const std::string &table, const std::string &key, int len,
+                                      const ScanBounds &bounds,
+                                      const std::vector<std::string> *fields,
+                                      const ScanVisitor &visitor) {
+  WT_ITEM k = {key.data(), key.size()};
+  WT_ITEM v;
+  int ret = 0, exact;
+  std::vector<FieldView> values;
+
+  cursor_->set_key(cursor_, &k);
+  error_check(cursor_->search_near(cursor_, &exact));
+  if (!bounds.reverse && exact < 0) {
+    ret = cursor_->next(cursor_);
+  } else if (bounds.reverse && exact > 0) {
+    ret = cursor_->prev(cursor_);
+  }
+  for(int i=0; !ret && i<len; ++i){
+    error_check(cursor_->get_key(cursor_, &k));
+    const std::string_view cur_key(static_cast<const char *>(k.data), k.size);
+    if (!bounds.end_key.empty()) {
+      int c = cur_key.compare(bounds.end_key);
+      if (bounds.reverse ? c <= 0 : c >= 0) {
+        break;
+      }
     }
+    // v points into the page the cursor is positioned on
+    error_check(cursor_->get_value(cursor_, &v));
+    const char *data = static_cast<const char *>(v.data);
+    values.clear();
+    codec_.DecodeView(data, data + v.size, fields, values);
+    if (!visitor(cur_key, values)) {
+      break;
+    }
+    ret = bounds.reverse ? cursor_->prev(cursor_) : cursor_->next(cursor_);
   }
   return kOK;
 }
 
 DB::Status WTDB::UpdateSingleEntry(const std::string &table, const std::string &key,
                            std::vector<Field> &values){
-  std::vector<Field> current_values;
   WT_ITEM k = {key.data(), key.size()};
   WT_ITEM v;
   int ret;
@@ -261,44 +379,80 @@ DB::Status WTDB::UpdateSingleEntry(const std::string &table, const std::string &
   ret = cursor_->search(cursor_);
   if(ret==WT_NOTFOUND){
     return kNotFound;
+  } else if(ret==WT_ROLLBACK){
+    return kAborted;
   } else if(ret != 0) {
     throw utils::Exception(WT_PREFIX " search error");
   }
   error_check(cursor_->get_value(cursor_, &v));
-  DeserializeRow(&current_values, (const char*)v.data, v.size);
-  for (Field &new_field : values) {
-    bool found MAYBE_UNUSED = false;
-    for (Field &cur_field : current_values) {
-      if (cur_field.name == new_field.name) {
-        found = true;
-        cur_field.value = new_field.value;
-        break;
-      }
-    }
-    assert(found);
-  }
-
+  const char *current = static_cast<const char *>(v.data);
   std::string data;
-  SerializeRow(current_values, &data);
+  codec_.Update(current, current + v.size, values, data);
   v.data = data.data();
   v.size = data.size();
   cursor_->set_value(cursor_, &v);
   ret = cursor_->update(cursor_);
   if(ret==WT_NOTFOUND){
     return kNotFound;
+  } else if(ret==WT_ROLLBACK){
+    return kAborted;
   } else if(ret != 0) {
     throw utils::Exception(WT_PREFIX " update error");
   }
   return kOK;
 }
 
+DB::Status WTDB::ReadModifyWriteSingleEntry(const std::string &table, const std::string &key,
+                                            const std::vector<std::string> *fields,
+                                            const RowVisitor &visitor,
+                                            std::vector<Field> &values){
+  WT_ITEM k = {key.data(), key.size()};
+  WT_ITEM v;
+  int ret;
+
+  // a conflicting update of the record between the search and the update
+  // rolls the transaction back
+  error_check(session_->begin_transaction(session_, "isolation=snapshot"));
+  cursor_->set_key(cursor_, &k);
+  ret = cursor_->search(cursor_);
+  if(ret == 0){
+    error_check(cursor_->get_value(cursor_, &v));
+    const char *current = static_cast<const char *>(v.data);
+    std::vector<FieldView> current_values;
+    codec_.DecodeView(current, current + v.size, fields, current_values);
+    visitor(current_values);
+    std::string data;
+    codec_.Update(current, current + v.size, values, data);
+    v.data = data.data();
+    v.size = data.size();
+    cursor_->set_value(cursor_, &v);
+    ret = cursor_->update(cursor_);
+    if(ret == 0){
+      ret = session_->commit_transaction(session_, NULL);
+      if(ret == 0){
+        return kOK;
+      } else if(ret==WT_ROLLBACK){
+        return kAborted;
+      }
+      throw utils::Exception(WT_PREFIX " commit error");
+    }
+  }
+  error_check(session_->rollback_transaction(session_, NULL));
+  if(ret==WT_NOTFOUND){
+    return kNotFound;
+  } else if(ret==WT_ROLLBACK){
+    return kAborted;
+  }
+  throw utils::Exception(WT_PREFIX " read-modify-write error");
+}
+
 DB::Status WTDB::InsertSingleEntry(const std::string &table, const std::string &key,
                            std::vector<Field> &values){
   std::string data;
   WT_ITEM k = {key.data(), key.size()}, v;
   
   cursor_->set_key(cursor_, &k);
-  SerializeRow(values, &data);
+  codec_.Encode(values, data);
   v.data = data.data();
   v.size = data.size();
   cursor_->set_value(cursor_, &v);
@@ -313,56 +467,42 @@ DB::Status WTDB::DeleteSingleEntry(const std::string &table, const std::string &
   return kOK;
 }
 
-void WTDB::SerializeRow(const std::vector<Field> &values, std::string *data) {
-  for (const Field &field : values) {
-    uint32_t len = field.name.size();
-    data->append(reinterpret_cast<char *>(&len), sizeof(uint32_t)); // 4B
-    data->append(field.name.data(), field.name.size());             // len(name)
-    len = field.value.size();
-    data->append(reinterpret_cast<char *>(&len), sizeof(uint32_t)); // 4B
-    data->append(field.value.data(), field.value.size());           // len(value)
+class WTDB::WTTransaction : public DB::Transaction {
+ public:
+  WTTransaction(WTDB *db) : db_(db) {}
+
+  Status Read(const std::string &table, const std::string &key,
+              const std::vector<std::string> *fields, std::vector<Field> &result) {
+    return db_->Read(table, key, fields, result);
   }
-}
 
-void WTDB::DeserializeRow(std::vector<Field> *values, const char *data_ptr, size_t data_len) {
-  const char *p = data_ptr;
-  const char *lim = p + data_len;
-  while (p != lim) {
-    assert(p < lim);
-    uint32_t len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string field(p, static_cast<const size_t>(len));
-    p += len;
-    len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string value(p, static_cast<const size_t>(len));
-    p += len;
-    values->push_back({field, value});
+  Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
+    return db_->Update(table, key, values);
   }
-  assert(values->size() == fieldcount_);
-}
 
-void WTDB::DeserializeRowFilter(std::vector<Field> *values, const char *data_ptr, size_t data_len,
-                                  const std::vector<std::string> &fields) {
-  const char *p = data_ptr;
-  const char *lim = p + data_len;
-  std::vector<std::string>::const_iterator filter_iter = fields.begin();
-  while (p != lim && filter_iter != fields.end()) {
-    assert(p < lim);
-    uint32_t len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string field(p, static_cast<const size_t>(len));
-    p += len;
-    len = *reinterpret_cast<const uint32_t *>(p);
-    p += sizeof(uint32_t);
-    std::string value(p, static_cast<const size_t>(len));
-    p += len;
-    if (*filter_iter == field) {
-      values->push_back({field, value});
-      filter_iter++;
+  Status Commit() {
+    // a failed commit rolls the transaction back
+    int ret = db_->session_->commit_transaction(db_->session_, NULL);
+    if(ret==WT_ROLLBACK){
+      return kAborted;
+    } else if(ret != 0) {
+      throw utils::Exception(WT_PREFIX " commit error");
     }
+    return kOK;
   }
-  assert(values->size() == fields.size());
+
+  void Rollback() {
+    error_check(db_->session_->rollback_transaction(db_->session_, NULL));
+  }
+
+ private:
+  WTDB *db_;
+};
+
+DB::Status WTDB::BeginTransaction(Transaction **txn) {
+  error_check(session_->begin_transaction(session_, "isolation=snapshot"));
+  *txn = new WTTransaction(this);
+  return kOK;
 }
 
 DB *NewWTDB() {
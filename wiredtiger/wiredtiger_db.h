@@ -4,10 +4,12 @@
 #ifndef _WIREDTIGER_DB_H
 #define _WIREDTIGER_DB_H
 
+#include <map>
 #include <string>
 #include <mutex>
 
 #include "core/db.h"
+#include "core/row_codec.h"
 #include "utils/properties.h"
 
 #include "wiredtiger.h"
@@ -24,20 +26,46 @@ class WTDB : public DB {
 
   void Cleanup();
 
+  void GetStats(std::vector<Field> &stats);
+
+  std::string GetDataPath();
+
   Status Read(const std::string &table, const std::string &key,
               const std::vector<std::string> *fields, std::vector<Field> &result) {
     return (this->*(method_read_))(table, key, fields, result);
   }
 
+  Status ReadView(const std::string &table, const std::string &key,
+                  const std::vector<std::string> *fields, const RowVisitor &visitor) {
+    return (this->*(method_read_view_))(table, key, fields, visitor);
+  }
+
   Status Scan(const std::string &table, const std::string &key, int len,
               const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result) {
     return (this->*(method_scan_))(table, key, len, fields, result);
   }
 
+  Status ScanView(const std::string &table, const std::string &key, int len,
+                  const std::vector<std::string> *fields, const ScanVisitor &visitor) {
+    return (this->*(method_scan_view_))(table, key, len, fields, visitor);
+  }
+
+  Status ScanRange(const std::string &table, const std::string &key, int len,
+                   const ScanBounds &bounds, const std::vector<std::string> *fields,
+                   const ScanVisitor &visitor) {
+    return (this->*(method_scan_range_))(table, key, len, bounds, fields, visitor);
+  }
+
   Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
     return (this->*(method_update_))(table, key, values);
   }
 
+  Status ReadModifyWrite(const std::string &table, const std::string &key,
+                         const std::vector<std::string> *fields, const RowVisitor &visitor,
+                         std::vector<Field> &values) {
+    return (this->*(method_read_modify_write_))(table, key, fields, visitor, values);
+  }
+
   Status Insert(const std::string &table, const std::string &key, std::vector<Field> &values) {
     return (this->*(method_insert_))(table, key, values);
   }
@@ -46,41 +74,66 @@ class WTDB : public DB {
     return (this->*(method_delete_))(table, key);
   }
 
+  Status BeginTransaction(Transaction **txn);
+
  private:
+  class WTTransaction;
 
   Status ReadSingleEntry(const std::string &table, const std::string &key,
                          const std::vector<std::string> *fields, std::vector<Field> &result);
+  Status ReadViewSingleEntry(const std::string &table, const std::string &key,
+                             const std::vector<std::string> *fields, const RowVisitor &visitor);
   Status ScanSingleEntry(const std::string &table, const std::string &key, int len,
                          const std::vector<std::string> *fields,
                          std::vector<std::vector<Field>> &result);
+  Status ScanViewSingleEntry(const std::string &table, const std::string &key, int len,
+                             const std::vector<std::string> *fields, const ScanVisitor &visitor);
+  Status ScanRangeSingleEntry(const std::string &table, const std::string &key, int len,
+                              const ScanBounds &bounds, const std::vector<std::string> *fields,
+                              const ScanVisitor &visitor);
   Status UpdateSingleEntry(const std::string &table, const std::string &key,
                            std::vector<Field> &values);
+  Status ReadModifyWriteSingleEntry(const std::string &table, const std::string &key,
+                                    const std::vector<std::string> *fields,
+                                    const RowVisitor &visitor, std::vector<Field> &values);
   Status InsertSingleEntry(const std::string &table, const std::string &key,
                            std::vector<Field> &values);
   Status DeleteSingleEntry(const std::string &table, const std::string &key);
 
-  void SerializeRow(const std::vector<Field> &values, std::string *data);
-  void DeserializeRow(std::vector<Field> *values, const char *data_ptr, size_t data_len);
-  void DeserializeRowFilter(std::vector<Field> *values, const char *data_ptr, size_t data_len, const std::vector<std::string> &fields);
-
   Status (WTDB::*method_read_)(const std::string &, const std:: string &,
                                     const std::vector<std::string> *, std::vector<Field> &);
+  Status (WTDB::*method_read_view_)(const std::string &, const std::string &,
+                                    const std::vector<std::string> *, const RowVisitor &);
+  Status (WTDB::*method_scan_view_)(const std::string &, const std::string &, int,
+                                    const std::vector<std::string> *, const ScanVisitor &);
+  Status (WTDB::*method_scan_range_)(const std::string &, const std::string &, int,
+                                     const ScanBounds &, const std::vector<std::string> *,
+                                     const ScanVisitor &);
   Status (WTDB::*method_scan_)(const std::string &, const std::string &, int,
                                     const std::vector<std::string> *,
                                     std::vector<std::vector<Field>> &);
+  Status (WTDB::*method_read_modify_write_)(const std::string &, const std::string &,
+                                            const std::vector<std::string> *,
+                                            const RowVisitor &, std::vector<Field> &);
   Status (WTDB::*method_update_)(const std::string &, const std::string &,
                                       std::vector<Field> &);
   Status (WTDB::*method_insert_)(const std::string &, const std::string &,
                                       std::vector<Field> &);
   Status (WTDB::*method_delete_)(const std::string &, const std::string &);
   
-  unsigned fieldcount_;
+  RowCodec codec_;
 
-  static WT_CONNECTION *conn_;
+  WT_CONNECTION *conn_{nullptr};
   WT_SESSION *session_{nullptr};
   WT_CURSOR *cursor_{nullptr};
-
-  static int ref_cnt_;
+  std::string home_;
+
+  // connections open in this process by home, each shared by the instances on it
+  struct OpenConn {
+    WT_CONNECTION *conn = nullptr;
+    int ref_cnt = 0;
+  };
+  static std::map<std::string, OpenConn> open_conns_;
   static std::mutex mu_;
 
 };